@@ -0,0 +1,75 @@
+#include "BiquadBank.h"
+#include <math.h>
+
+static const int COEFFICIENT_BITS = 29;
+
+static int32_t toQ29(double value) {
+    return static_cast<int32_t>(lrint(value * (1 << COEFFICIENT_BITS)));
+}
+
+static BiquadCoefficients normalise(double b0, double b1, double b2, double a0, double a1, double a2) {
+    return { toQ29(b0 / a0), toQ29(b1 / a0), toQ29(b2 / a0), toQ29(a1 / a0), toQ29(a2 / a0) };
+}
+
+BiquadCoefficients biquadLowPass(float cutoff, float q, float sampleRate) {
+    double w = 2 * M_PI * cutoff / sampleRate;
+    double alpha = sin(w) / (2 * q);
+    double c = cos(w);
+    return normalise((1 - c) / 2, 1 - c, (1 - c) / 2, 1 + alpha, -2 * c, 1 - alpha);
+}
+
+BiquadCoefficients biquadHighPass(float cutoff, float q, float sampleRate) {
+    double w = 2 * M_PI * cutoff / sampleRate;
+    double alpha = sin(w) / (2 * q);
+    double c = cos(w);
+    return normalise((1 + c) / 2, -(1 + c), (1 + c) / 2, 1 + alpha, -2 * c, 1 - alpha);
+}
+
+BiquadCoefficients biquadBandPass(float centre, float q, float sampleRate) {
+    double w = 2 * M_PI * centre / sampleRate;
+    double alpha = sin(w) / (2 * q);
+    double c = cos(w);
+    return normalise(alpha, 0, -alpha, 1 + alpha, -2 * c, 1 - alpha);
+}
+
+bool BiquadBank::addSection(const BiquadCoefficients& coefficients) {
+    if (sectionCount == MAX_SECTIONS) {
+        return false;
+    }
+    sections[sectionCount] = {};
+    sections[sectionCount].c = coefficients;
+    ++sectionCount;
+    return true;
+}
+
+void BiquadBank::clearSections() {
+    sectionCount = 0;
+}
+
+void BiquadBank::reset() {
+    for (size_t s = 0; s < sectionCount; ++s) {
+        BiquadCoefficients c = sections[s].c;
+        sections[s] = {};
+        sections[s].c = c;
+    }
+}
+
+void BiquadBank::process(int32_t samples[LANES]) {
+    for (size_t s = 0; s < sectionCount; ++s) {
+        Section& section = sections[s];
+        const BiquadCoefficients& c = section.c;
+        // Lane loop innermost: the same coefficients for all four wheels
+        for (size_t i = 0; i < LANES; ++i) {
+            int64_t acc = static_cast<int64_t>(c.b0) * samples[i] + static_cast<int64_t>(c.b1) * section.x1[i] +
+                          static_cast<int64_t>(c.b2) * section.x2[i] - static_cast<int64_t>(c.a1) * section.y1[i] -
+                          static_cast<int64_t>(c.a2) * section.y2[i];
+            int64_t y = (acc + (int64_t(1) << (COEFFICIENT_BITS - 1))) >> COEFFICIENT_BITS;
+            y = y > INT32_MAX ? INT32_MAX : (y < INT32_MIN ? INT32_MIN : y);
+            section.x2[i] = section.x1[i];
+            section.x1[i] = samples[i];
+            section.y2[i] = section.y1[i];
+            section.y1[i] = static_cast<int32_t>(y);
+            samples[i] = static_cast<int32_t>(y);
+        }
+    }
+}
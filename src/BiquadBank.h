@@ -0,0 +1,46 @@
+#ifndef BIQUADBANK_H
+#define BIQUADBANK_H
+
+#include <inttypes.h>
+#include <stddef.h>
+
+// Second order section, a0 normalised to 1, coefficients in Q29 so poles
+// close to the unit circle (low cutoff at packet rate) keep their precision
+struct BiquadCoefficients {
+    int32_t b0, b1, b2, a1, a2;
+};
+
+// RBJ cookbook designs, computed once in float when the bank is configured.
+// The band-pass has 0 dB gain at its centre.
+BiquadCoefficients biquadLowPass(float cutoff, float q, float sampleRate);
+BiquadCoefficients biquadHighPass(float cutoff, float q, float sampleRate);
+BiquadCoefficients biquadBandPass(float centre, float q, float sampleRate);
+
+// Cascade of biquads run in fixed point on four lanes at once (one per
+// wheel), integer only so it stays cheap on the ESP32. Direct form I with a
+// 64 bit accumulator: the state holds plain samples and cannot overflow
+// internally. Samples are Q16.
+class BiquadBank {
+    public:
+        static constexpr size_t LANES = 4;
+        static constexpr size_t MAX_SECTIONS = 4;
+        static constexpr int32_t ONE = 1 << 16;
+
+        // Appends a section to the cascade, false when it is full
+        bool addSection(const BiquadCoefficients& coefficients);
+        void clearSections();
+        // Zeroes the filter state, e.g. after a gap in the input
+        void reset();
+        // Filters one sample per lane in place
+        void process(int32_t samples[LANES]);
+
+    private:
+        struct Section {
+            BiquadCoefficients c;
+            int32_t x1[LANES], x2[LANES], y1[LANES], y2[LANES];
+        };
+        Section sections[MAX_SECTIONS] = {};
+        size_t sectionCount = 0;
+};
+
+#endif
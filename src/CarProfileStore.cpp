@@ -0,0 +1,126 @@
+#include "CarProfileStore.h"
+#include "VibrationConfig.h"
+
+// getPowertrainType() of a car without a fuel tank
+static const uint8_t ELECTRIC_POWERTRAIN = 1;
+// Below the engine is off (or the car sits in a menu)
+static const float MIN_RUNNING_RPM = 300;
+// Changes of the current car are saved while it stands still, at most this often
+static const float STANDSTILL_KMH = 1;
+static const uint32_t STANDSTILL_SAVE_MICROS = 10000000;
+
+static const size_t CAR_PROFILE_BLOB_SIZE = sizeof(ConfigBlobHeader) + sizeof(CarProfile);
+
+void CarProfileStore::begin(CarProfileStorage* storage) {
+    this->storage = storage;
+}
+
+bool CarProfileStore::requestOverrides(const CarOverrides& request) {
+    return overrides.push(request);
+}
+
+void CarProfileStore::save(Entry& entry) {
+    if (!entry.dirty || storage == nullptr) {
+        return;
+    }
+    uint8_t blob[CAR_PROFILE_BLOB_SIZE];
+    encodeConfigBlob(CAR_PROFILE_MAGIC, CAR_PROFILE_LAYOUT, &entry.profile, sizeof(entry.profile), blob);
+    if (storage->save(entry.profile.carCode, blob, sizeof(blob))) {
+        entry.dirty = false;
+    } else {
+        saveFailures.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void CarProfileStore::flush() {
+    for (Entry& entry : entries) {
+        if (entry.lastUse != 0) {
+            save(entry);
+        }
+    }
+}
+
+CarProfileStore::Entry& CarProfileStore::select(int32_t carCode, uint8_t powertrainType) {
+    Entry* victim = &entries[0];
+    for (Entry& entry : entries) {
+        if (entry.lastUse != 0 && entry.profile.carCode == carCode) {
+            entry.lastUse = ++useCounter;
+            return entry;
+        }
+        if (entry.lastUse < victim->lastUse) {
+            victim = &entry;
+        }
+    }
+
+    // Least recently used car makes room, its changes go to storage first
+    if (victim->lastUse != 0) {
+        save(*victim);
+    }
+    victim->lastUse = ++useCounter;
+    victim->dirty = false;
+    uint8_t blob[CAR_PROFILE_BLOB_SIZE];
+    size_t length = storage != nullptr ? storage->load(carCode, blob, sizeof(blob)) : 0;
+    if (decodeConfigBlob(CAR_PROFILE_MAGIC, CAR_PROFILE_LAYOUT, blob, length, &victim->profile, sizeof(victim->profile)) &&
+        victim->profile.carCode == carCode) {
+        loads.fetch_add(1, std::memory_order_relaxed);
+        return *victim;
+    }
+    CarProfile& profile = victim->profile;
+    profile = {};
+    profile.carCode = carCode;
+    profile.powertrainType = powertrainType;
+    profile.rpmIntensity = NO_INTENSITY_OVERRIDE;
+    profile.tireSlipIntensity = NO_INTENSITY_OVERRIDE;
+    profile.suspHeightIntensity = NO_INTENSITY_OVERRIDE;
+    return *victim;
+}
+
+void CarProfileStore::learn(Entry& entry, const TelemetryFrame& frame) {
+    CarProfile& profile = entry.profile;
+    float rpm = frame.rpm;
+    // Electric motors idle at 0, the range starts there
+    if (frame.powertrainType == ELECTRIC_POWERTRAIN) {
+        entry.dirty |= profile.idleRPM != 0;
+        profile.idleRPM = 0;
+    } else if (rpm >= MIN_RUNNING_RPM && (profile.idleRPM == 0 || rpm < profile.idleRPM)) {
+        profile.idleRPM = rpm;
+        entry.dirty = true;
+    }
+    // GT7 reports where the rev limiter warning ends for most cars, that is
+    // the top of the range; otherwise the highest rpm seen so far
+    float redline = frame.maxAlertRPM > 0 ? static_cast<float>(frame.maxAlertRPM) : (rpm > profile.redlineRPM ? rpm : profile.redlineRPM);
+    if (redline != profile.redlineRPM) {
+        profile.redlineRPM = redline;
+        entry.dirty = true;
+    }
+    profile.powertrainType = frame.powertrainType;
+}
+
+void CarProfileStore::process(TelemetryFrame& frame) {
+    if (active == nullptr || active->profile.carCode != frame.carCode) {
+        // The car left behind is saved now, a car change happens in the
+        // menus, where a flash write does not hurt
+        if (active != nullptr) {
+            save(*active);
+        }
+        active = &select(frame.carCode, frame.powertrainType);
+    }
+
+    // Overrides meant for a car that is no longer driven are dropped
+    CarOverrides request;
+    while (overrides.pop(request)) {
+        if (request.carCode == active->profile.carCode) {
+            active->profile.rpmIntensity = request.rpmIntensity;
+            active->profile.tireSlipIntensity = request.tireSlipIntensity;
+            active->profile.suspHeightIntensity = request.suspHeightIntensity;
+            active->dirty = true;
+        }
+    }
+
+    learn(*active, frame);
+    if (active->dirty && frame.speed < STANDSTILL_KMH && frame.receivedMicros - lastSaveMicros >= STANDSTILL_SAVE_MICROS) {
+        lastSaveMicros = frame.receivedMicros;
+        save(*active);
+    }
+    frame.car = active->profile;
+}
@@ -0,0 +1,77 @@
+#ifndef CARPROFILESTORE_H
+#define CARPROFILESTORE_H
+
+#include <atomic>
+#include <inttypes.h>
+#include <stddef.h>
+#include "SpscQueue.h"
+#include "TelemetryFrame.h"
+
+// Blobs keyed by carCode (NVS on the ESP32, one file per car on the host)
+class CarProfileStorage {
+    public:
+        virtual ~CarProfileStorage() = default;
+        // Returns the stored length, 0 if there is nothing or it does not fit
+        virtual size_t load(int32_t carCode, uint8_t* data, size_t capacity) = 0;
+        virtual bool save(int32_t carCode, const uint8_t* data, size_t length) = 0;
+};
+
+// Intensity overrides for one car, set from another task
+struct CarOverrides {
+    int32_t carCode;
+    int8_t rpmIntensity;
+    int8_t tireSlipIntensity;
+    int8_t suspHeightIntensity;
+};
+
+// Bump whenever CarProfile changes, stored profiles of another layout are
+// relearned from scratch
+constexpr uint16_t CAR_PROFILE_LAYOUT = 1;
+constexpr uint32_t CAR_PROFILE_MAGIC = 0x50375447; // "GT7P"
+
+// Learns the rpm range of every car driven and keeps it, with the intensity
+// overrides, per carCode. Runs in the ingest task: process() looks at each
+// accepted packet and copies the profile of the current car into the frame.
+// Recently driven cars stay in a small LRU cache, so switching back and
+// forth costs a lookup in CACHE_SIZE entries. Storage is only touched when
+// the car changes (load on a miss, save of the car left behind if it
+// learned something) or stands still, never while driving.
+class CarProfileStore {
+    public:
+        static constexpr size_t CACHE_SIZE = 8;
+
+        // storage may be nullptr, profiles then live until the cache evicts them
+        void begin(CarProfileStorage* storage);
+        void process(TelemetryFrame& frame);
+        // Any other task, applied with the next packet if that car is still
+        // driven. False if too many requests are pending.
+        bool requestOverrides(const CarOverrides& overrides);
+        // Saves every changed profile in the cache, e.g. before shutdown.
+        // Same task as process().
+        void flush();
+        // Any task
+        uint32_t getLoads() const { return loads.load(std::memory_order_relaxed); }
+        uint32_t getSaveFailures() const { return saveFailures.load(std::memory_order_relaxed); }
+
+    private:
+        struct Entry {
+            CarProfile profile;
+            uint32_t lastUse;  // 0: empty
+            bool dirty;
+        };
+
+        Entry& select(int32_t carCode, uint8_t powertrainType);
+        void save(Entry& entry);
+        void learn(Entry& entry, const TelemetryFrame& frame);
+
+        CarProfileStorage* storage = nullptr;
+        Entry entries[CACHE_SIZE] = {};
+        Entry* active = nullptr;
+        uint32_t useCounter = 0;
+        uint32_t lastSaveMicros = 0;
+        std::atomic<uint32_t> loads{0};
+        std::atomic<uint32_t> saveFailures{0};
+        SpscQueue<CarOverrides, 4> overrides;
+};
+
+#endif
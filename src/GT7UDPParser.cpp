@@ -1,22 +1,15 @@
-#include <WiFiUdp.h>
 #include "GT7UDPParser.h"
-#include "Salsa20.h"
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
 #include <string>
 //#include <span>
 #include <array>
-#include <vector>
 
-constexpr unsigned int localPort = 33740; 
-constexpr unsigned int remotePort = 33739; 
-constexpr char heartbeatMsg = 'A';
-const std::string Key = "Simulator Interface Packet GT7 ver 0.0";
-
-Packet packet;
-
-union IntToBytes {
-    uint32_t integer;
-    uint8_t bytes[4];
-};
+constexpr int32_t packetIdResync = 600; // ~10 s at 60 Hz, larger jumps back mean a new session
+constexpr uint32_t maxDrainPerRead = 64; // bounds the time spent in one readData() under flooding
+// Blocks decrypted before a datagram is accepted as candidate: magic and packetId
+constexpr size_t headerBytes = (offsetof(GT7Packet, packetId) / Salsa20Engine::BLOCK_SIZE + 1) * Salsa20Engine::BLOCK_SIZE;
 
 std::array<uint8_t, 32> GT7_UDP_Parser::getAsciiBytes(const std::string& inputString) {
     std::array<uint8_t, 32> asciiBytes = {};
@@ -26,33 +19,75 @@ std::array<uint8_t, 32> GT7_UDP_Parser::getAsciiBytes(const std::string& inputSt
     return asciiBytes;
 }
 
-void GT7_UDP_Parser::begin(const IPAddress playstationIP) {
-    Udp.begin(localPort);
-    remoteIP = playstationIP;
-    dKey = getAsciiBytes(Key);
+void GT7_UDP_Parser::begin(PacketSource& source) {
+    this->source = &source;
+    source.begin(gt7ReceivePort);
+    dKey = getAsciiBytes(gt7Key);
+    salsa20.setKey(dKey.data());
+}
+
+void GT7_UDP_Parser::setIngestMode(IngestMode mode) {
+    ingestMode = mode;
+}
+
+template <GT7PacketVariant V>
+static bool matchHeartbeat(char heartbeat, GT7PacketVariant& variant) {
+    if (heartbeat != GT7PacketLayout<V>::heartbeat) {
+        return false;
+    }
+    variant = V;
+    return true;
+}
+
+template <GT7PacketVariant V>
+static bool matchSize(size_t size, GT7PacketVariant& variant) {
+    if (size != sizeof(typename GT7PacketLayout<V>::Type)) {
+        return false;
+    }
+    variant = V;
+    return true;
+}
+
+bool gt7PacketVariantForHeartbeat(char heartbeat, GT7PacketVariant& variant) {
+    return matchHeartbeat<GT7PacketVariant::A>(heartbeat, variant) || matchHeartbeat<GT7PacketVariant::B>(heartbeat, variant) ||
+           matchHeartbeat<GT7PacketVariant::Tilde>(heartbeat, variant);
+}
+
+bool gt7PacketVariantForSize(size_t size, GT7PacketVariant& variant) {
+    return matchSize<GT7PacketVariant::A>(size, variant) || matchSize<GT7PacketVariant::B>(size, variant) ||
+           matchSize<GT7PacketVariant::Tilde>(size, variant);
+}
+
+void GT7_UDP_Parser::setPacketVariant(GT7PacketVariant variant) {
+    if (variant < GT7PacketVariant::Count) {
+        this->variant = variant;
+    }
+}
+
+GT7PacketVariant GT7_UDP_Parser::getPacketVariant(void) const {
+    return variant;
 }
 
 void GT7_UDP_Parser::sendHeartbeat(void) {
-    Udp.beginPacket(remoteIP, remotePort);
-    Udp.write(heartbeatMsg);
-    Udp.endPacket();
+    const uint8_t msg = variantOps[static_cast<size_t>(variant)].heartbeat;
+    source->send(gt7HeartbeatPort, &msg, sizeof(msg));
 }
 
-uint8_t GT7_UDP_Parser::getCurrentGearFromByte(void) {
-    return packet.packetContent.gears & 0b00001111; // Extract the lower 4 bits for gears
+uint8_t GT7_UDP_Parser::getCurrentGearFromByte(void) const {
+    return slots[front].packetContent.gears & 0b00001111; // Extract the lower 4 bits for gears
 }
 
 // Function to extract suggested gear from the byte
-uint8_t GT7_UDP_Parser::getSuggestedGearFromByte(void) {
-    return packet.packetContent.gears >> 4; // Shift right by 4 bits to get the upper 4 bits for suggested gear
+uint8_t GT7_UDP_Parser::getSuggestedGearFromByte(void) const {
+    return slots[front].packetContent.gears >> 4; // Shift right by 4 bits to get the upper 4 bits for suggested gear
 }
 
 
-uint8_t GT7_UDP_Parser::getPowertrainType(void) {
-    if (static_cast<uint8_t>(packet.packetContent.fuelCapacity) > 10) {
+uint8_t GT7_UDP_Parser::getPowertrainType(void) const {
+    if (static_cast<uint8_t>(slots[front].packetContent.fuelCapacity) > 10) {
     return 0;
     } else {
-        switch(static_cast<uint8_t>(packet.packetContent.fuelCapacity)) {
+        switch(static_cast<uint8_t>(slots[front].packetContent.fuelCapacity)) {
             case 0: return 1;
                 break;
             case 5: return 2;
@@ -62,22 +97,22 @@ uint8_t GT7_UDP_Parser::getPowertrainType(void) {
     }
 }
 
-float GT7_UDP_Parser::getTyreSpeed(int index) {
+float GT7_UDP_Parser::getTyreSpeed(int index) const {
     if (index >= 0 && index < 4) {
-        return abs(3.6f * packet.packetContent.tyreRadius[index] * packet.packetContent.wheelRPS[index]);
+        return fabsf(3.6f * slots[front].packetContent.tyreRadius[index] * slots[front].packetContent.wheelRPS[index]);
     } else return 0.0f;
 }
 
-float GT7_UDP_Parser::getTyreSlipRatio(int index) {
-    float carSpeed = (packet.packetContent.speed * 3.6);
+float GT7_UDP_Parser::getTyreSlipRatio(int index) const {
+    float carSpeed = (slots[front].packetContent.speed * 3.6);
     float tyreSpeed = getTyreSpeed(index);
     if (carSpeed != 0.0f) {
         return tyreSpeed / carSpeed;
     } else return 0.0f;
 }
 
-uint8_t GT7_UDP_Parser::getFlag(int index) {
-    SimulatorFlags flags = packet.packetContent.flags;
+uint8_t GT7_UDP_Parser::getFlag(int index) const {
+    SimulatorFlags flags = slots[front].packetContent.flags;
     int16_t indexAdjusted = index - 1;
     if (index < 0 || index > 13) {
         return 0;
@@ -90,29 +125,169 @@ uint8_t GT7_UDP_Parser::getFlag(int index) {
     }
 }
 
-Packet GT7_UDP_Parser::readData(void) {
-    uint8_t recvBuffer[sizeof(packet.packetContent)];
-    memset(recvBuffer, 0, sizeof(packet.packetContent));
-    Udp.parsePacket();
-    if (Udp.read(recvBuffer, sizeof(recvBuffer)) == sizeof(packet.packetContent)) {
-    int iv1 = *reinterpret_cast<int*>(&recvBuffer[0x40]); // Seed IV is always located there
-    int iv2 = iv1 ^ 0xDEADBEAF;
-    IntToBytes iv1Bytes, iv2Bytes;
-    iv1Bytes.integer = iv1;
-    iv2Bytes.integer = iv2;
+static int32_t packetIdDelta(int32_t packetId, int32_t reference) {
+    return static_cast<int32_t>(static_cast<uint32_t>(packetId) - static_cast<uint32_t>(reference));
+}
+
+// Receives one datagram into slot, checks its size, decrypts only the first
+// block to check the magic and then the block holding the packetId. Returns 0 if nothing was pending, -1 if the
+// datagram was rejected and 1 for a candidate whose IV is stored in iv.
+template <GT7PacketVariant V>
+int GT7_UDP_Parser::receiveHeader(uint8_t slot, uint8_t iv[8]) {
+    typedef GT7PacketLayout<V> Layout;
+    uint8_t* data = reinterpret_cast<uint8_t*>(&slots[slot]);
+    int length = source->receive(data, sizeof(typename Layout::Type));
+    if (length == 0) {
+        return 0;
+    }
+    slotReceivedMicros[slot] = clockMicros();
+    stats.received.fetch_add(1, std::memory_order_relaxed);
+    if (length < static_cast<int>(sizeof(typename Layout::Type))) {
+        stats.rejectedShort.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+    if (length > static_cast<int>(sizeof(typename Layout::Type))) {
+        stats.rejectedLong.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+
+    uint32_t iv1; // Seed IV is always located at 0x40
+    memcpy(&iv1, &data[0x40], sizeof(iv1));
+    uint32_t iv2 = iv1 ^ Layout::ivXor;
 
     // Construct the 8-byte initialization vector
-     uint8_t iv[8] = {
-        iv2Bytes.bytes[0], iv2Bytes.bytes[1], iv2Bytes.bytes[2], iv2Bytes.bytes[3],
-        iv1Bytes.bytes[0], iv1Bytes.bytes[1], iv1Bytes.bytes[2], iv1Bytes.bytes[3]
+    const uint8_t seedIv[8] = {
+        static_cast<uint8_t>(iv2), static_cast<uint8_t>(iv2 >> 8), static_cast<uint8_t>(iv2 >> 16), static_cast<uint8_t>(iv2 >> 24),
+        static_cast<uint8_t>(iv1), static_cast<uint8_t>(iv1 >> 8), static_cast<uint8_t>(iv1 >> 16), static_cast<uint8_t>(iv1 >> 24)
     };
+    memcpy(iv, seedIv, sizeof(seedIv));
 
-    ucstk::Salsa20 salsa20(dKey.data());
-    salsa20.setIv(iv);
+    // The magic sits in the first block, only spend the rest of the
+    // keystream on datagrams that really come from GT7
+    salsa20.process(iv, data, Salsa20Engine::BLOCK_SIZE);
+    if (slots[slot].packetContent.magic != gt7Magic) {
+        stats.rejectedMagic.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+    salsa20.process(iv, data + Salsa20Engine::BLOCK_SIZE, headerBytes - Salsa20Engine::BLOCK_SIZE, 1);
+
+    // Duplicates and packets overtaken by a newer one carry stale state
+    int32_t delta = packetIdDelta(slots[slot].packetContent.packetId, lastPacketId);
+    if (hasPacket && delta <= 0 && delta > -packetIdResync) {
+        stats.rejectedPacketId.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+    return 1;
+}
+
+const GT7_UDP_Parser::VariantOps GT7_UDP_Parser::variantOps[] = {
+    { GT7PacketLayout<GT7PacketVariant::A>::heartbeat, &GT7_UDP_Parser::readDataAs<GT7PacketVariant::A>, &GT7_UDP_Parser::decodeFrameAs<GT7PacketVariant::A> },
+    { GT7PacketLayout<GT7PacketVariant::B>::heartbeat, &GT7_UDP_Parser::readDataAs<GT7PacketVariant::B>, &GT7_UDP_Parser::decodeFrameAs<GT7PacketVariant::B> },
+    { GT7PacketLayout<GT7PacketVariant::Tilde>::heartbeat, &GT7_UDP_Parser::readDataAs<GT7PacketVariant::Tilde>, &GT7_UDP_Parser::decodeFrameAs<GT7PacketVariant::Tilde> },
+};
+
+bool GT7_UDP_Parser::readData(void) {
+    return (this->*variantOps[static_cast<size_t>(variant)].readData)();
+}
+
+template <GT7PacketVariant V>
+bool GT7_UDP_Parser::readDataAs(void) {
+    // Receive straight into a back slot and decrypt it in place. The front
+    // slot stays intact until a new packet has passed validation.
+    const uint8_t backA = (front + 1) % 3;
+    const uint8_t backB = (front + 2) % 3;
+    const uint8_t noSlot = 0xFF;
+    uint8_t candidate = noSlot;
+    uint8_t candidateIv[8];
+    uint32_t backlog = 0;
+
+    do {
+        uint8_t slot = candidate == backA ? backB : backA;
+        uint8_t iv[8];
+        int result = receiveHeader<V>(slot, iv);
+        if (result == 0) {
+            break;
+        }
+        ++backlog;
+        if (result < 0) {
+            continue;
+        }
+        if (candidate != noSlot) {
+            // Latest wins, whichever of the two is older gets dropped
+            stats.superseded.fetch_add(1, std::memory_order_relaxed);
+            if (packetIdDelta(slots[slot].packetContent.packetId, slots[candidate].packetContent.packetId) <= 0) {
+                continue;
+            }
+        }
+        candidate = slot;
+        memcpy(candidateIv, iv, sizeof(candidateIv));
+    } while (ingestMode == IngestMode::LatestWins && backlog < maxDrainPerRead);
+
+    if (backlog > 0) {
+        stats.lastBacklog.store(backlog, std::memory_order_relaxed);
+        if (backlog > stats.maxBacklog.load(std::memory_order_relaxed)) {
+            stats.maxBacklog.store(backlog, std::memory_order_relaxed);
+        }
+    }
+    if (candidate == noSlot) {
+        return false;
+    }
 
-    std::vector<uint8_t> decryptedData(sizeof(recvBuffer));
-    salsa20.processBytes((recvBuffer), decryptedData.data(), 0x128);
-    memcpy(&packet.packetContent, decryptedData.data(), sizeof(packet.packetContent));
-    } 
-    return packet;
-}
\ No newline at end of file
+    uint8_t* data = reinterpret_cast<uint8_t*>(&slots[candidate]);
+    salsa20.process(candidateIv, data + headerBytes, sizeof(typename GT7PacketLayout<V>::Type) - headerBytes, headerBytes / Salsa20Engine::BLOCK_SIZE);
+    lastPacketId = slots[candidate].packetContent.packetId;
+    hasPacket = true;
+
+    stats.accepted.fetch_add(1, std::memory_order_relaxed);
+    front = candidate;
+    return true;
+}
+
+const IngestStats& GT7_UDP_Parser::getIngestStats(void) const {
+    return stats;
+}
+
+const Packet& GT7_UDP_Parser::getPacket(void) const {
+    return slots[front];
+}
+
+void GT7_UDP_Parser::decodeFrame(TelemetryFrame& frame) const {
+    (this->*variantOps[static_cast<size_t>(variant)].decodeFrame)(frame);
+}
+
+template <GT7PacketVariant V>
+void GT7_UDP_Parser::decodeFrameAs(TelemetryFrame& frame) const {
+    typedef GT7PacketLayout<V> Layout;
+    const GT7Packet& p = slots[front].packetContent;
+    frame.receivedMicros = slotReceivedMicros[front];
+    frame.packetId = p.packetId;
+    frame.carCode = p.carCode;
+    frame.speed = p.speed * 3.6f;
+    frame.rpm = p.EngineRPM;
+    for (int i = 0; i < 4; ++i) {
+        frame.tyreSlipRatio[i] = getTyreSlipRatio(i);
+        frame.suspHeight[i] = p.suspHeight[i];
+        frame.wheelRPS[i] = p.wheelRPS[i];
+    }
+    frame.roadPlaneDistance = p.roadPlaneDistance;
+    frame.minAlertRPM = p.minAlertRPM;
+    frame.maxAlertRPM = p.maxAlertRPM;
+    frame.flags = static_cast<uint16_t>(p.flags);
+    frame.currentGear = getCurrentGearFromByte();
+    frame.suggestedGear = getSuggestedGearFromByte();
+    frame.throttle = p.throttle;
+    frame.brake = p.brake;
+    frame.powertrainType = getPowertrainType();
+    if constexpr (Layout::hasMotion) {
+        const GT7PacketMotion& motion = Layout::view(slots[front]).motion;
+        frame.wheelRotation = motion.wheelRotation;
+        frame.sway = motion.sway;
+        frame.heave = motion.heave;
+        frame.surge = motion.surge;
+    } else {
+        frame.wheelRotation = 0;
+        frame.sway = 0;
+        frame.heave = 0;
+        frame.surge = 0;
+    }
+}
@@ -2,8 +2,12 @@
 #define GT7UDPPARSER_H
 
 #include <inttypes.h>
-#include <WiFiUdp.h>
+#include <stddef.h>
+#include "Platform.h"
+#include "Salsa20Engine.h"
+#include "TelemetryFrame.h"
 #include <array>
+#include <atomic>
 #include <string>
 
 #pragma pack(push, 1)
@@ -85,26 +89,166 @@ int32_t carCode; // This value may be overriden if using a car with more then 9
 //
 };
 
+// Appended by heartbeat 'B' (316 bytes)
+struct GT7PacketMotion {
+float wheelRotation; // Steering wheel rotation in radians
+float fillerFB; // Unknown
+float sway; // Lateral acceleration in m/s^2
+float heave; // Vertical acceleration in m/s^2
+float surge; // Longitudinal acceleration in m/s^2
+};
+
+// Appended by heartbeat '~' (344 bytes) after the 'B' channels
+struct GT7PacketExtended {
+uint8_t throttleFiltered; // Throttle after assists (RANGE: 0 -> 255)
+uint8_t brakeFiltered; // Brake after assists (RANGE: 0 -> 255)
+uint8_t unknown0x13E[2];
+float torqueVectors[4]; // Torque vectoring per wheel
+float energyRecovery; // Energy recovery of hybrids and EVs
+float unknown0x154;
+};
+
+struct GT7PacketB {
+GT7Packet base;
+GT7PacketMotion motion;
+};
+
+struct GT7PacketTilde {
+GT7Packet base;
+GT7PacketMotion motion;
+GT7PacketExtended extended;
+};
+
+// Receive slot, big enough for every variant. The common part is always
+// read through packetContent, it sits at the same offsets in all layouts.
 struct Packet {
-    GT7Packet packetContent;
+    union {
+        GT7Packet packetContent;
+        GT7PacketB packetB;
+        GT7PacketTilde packetTilde;
+    };
 };
 
+static_assert(sizeof(GT7Packet) == 0x128, "GT7Packet must match the 296 byte heartbeat 'A' layout");
+static_assert(offsetof(GT7PacketB, motion.wheelRotation) == 0x128 && offsetof(GT7PacketB, motion.surge) == 0x138, "GT7PacketMotion offsets");
+static_assert(sizeof(GT7PacketB) == 0x13C, "GT7PacketB must match the 316 byte heartbeat 'B' layout");
+static_assert(offsetof(GT7PacketTilde, extended.throttleFiltered) == 0x13C && offsetof(GT7PacketTilde, extended.torqueVectors) == 0x140 &&
+              offsetof(GT7PacketTilde, extended.energyRecovery) == 0x150, "GT7PacketExtended offsets");
+static_assert(sizeof(GT7PacketTilde) == 0x158, "GT7PacketTilde must match the 344 byte heartbeat '~' layout");
+
 #pragma pack(pop)
 
+// Protocol constants, shared with the native PlayStation simulator
+constexpr uint16_t gt7ReceivePort = 33740;   // telemetry arrives here
+constexpr uint16_t gt7HeartbeatPort = 33739; // the PlayStation listens for heartbeats here
+constexpr int32_t gt7Magic = 0x47375330; // "G7S0" after decryption
+constexpr float gt7PacketRate = 60; // packets per second, one per packetId
+constexpr char gt7Key[] = "Simulator Interface Packet GT7 ver 0.0"; // Salsa20 key are the first 32 bytes
+
+// Ingest counters, bumped lock-free by readData() and readable from any task
+struct IngestStats {
+    std::atomic<uint32_t> received{0};
+    std::atomic<uint32_t> accepted{0};
+    std::atomic<uint32_t> rejectedShort{0};
+    std::atomic<uint32_t> rejectedLong{0};
+    std::atomic<uint32_t> rejectedMagic{0};
+    std::atomic<uint32_t> rejectedPacketId{0};
+    std::atomic<uint32_t> superseded{0};   // valid, but a newer packet was pending in the same tick
+    std::atomic<uint32_t> lastBacklog{0};  // datagrams drained by the last readData()
+    std::atomic<uint32_t> maxBacklog{0};
+};
+
+// The heartbeat byte selects which layout the PlayStation sends back
+enum class GT7PacketVariant : uint8_t {
+    A,     // 296 bytes, the original layout
+    B,     // 316 bytes, adds wheel rotation and sway/heave/surge
+    Tilde, // 344 bytes, additionally filtered pedals, torque vectoring and energy recovery
+    Count
+};
+
+// Compile-time description of a variant: packet type, datagram size, the
+// heartbeat that requests it and the constant XORed into the seed IV
+template <GT7PacketVariant V> struct GT7PacketLayout;
+
+template <> struct GT7PacketLayout<GT7PacketVariant::A> {
+    typedef GT7Packet Type;
+    static constexpr char heartbeat = 'A';
+    static constexpr uint32_t ivXor = 0xDEADBEAF;
+    static constexpr bool hasMotion = false;
+    static const Type& view(const Packet& packet) { return packet.packetContent; }
+};
+
+template <> struct GT7PacketLayout<GT7PacketVariant::B> {
+    typedef GT7PacketB Type;
+    static constexpr char heartbeat = 'B';
+    static constexpr uint32_t ivXor = 0xDEADBEEF;
+    static constexpr bool hasMotion = true;
+    static const Type& view(const Packet& packet) { return packet.packetB; }
+};
+
+template <> struct GT7PacketLayout<GT7PacketVariant::Tilde> {
+    typedef GT7PacketTilde Type;
+    static constexpr char heartbeat = '~';
+    static constexpr uint32_t ivXor = 0x55FABB4F;
+    static constexpr bool hasMotion = true;
+    static const Type& view(const Packet& packet) { return packet.packetTilde; }
+};
+
+// Variant requested by a heartbeat byte or sent as a datagram of the given
+// size (e.g. to pick the layout of a capture), false if there is none
+bool gt7PacketVariantForHeartbeat(char heartbeat, GT7PacketVariant& variant);
+bool gt7PacketVariantForSize(size_t size, GT7PacketVariant& variant);
+
+enum class IngestMode : uint8_t {
+    Single,     // one datagram per readData()
+    LatestWins  // drain everything pending, decode only the newest valid packet
+};
+
 class GT7_UDP_Parser {
     public:
-		void begin(const IPAddress playstationIP);
+		void begin(PacketSource& source);
 		void sendHeartbeat();
-        uint8_t getFlag(int index);
-        uint8_t getCurrentGearFromByte(void);
-        uint8_t getSuggestedGearFromByte(void);
-        uint8_t getPowertrainType(void);
-        float getTyreSpeed(int index);
-        float getTyreSlipRatio(int index);
-        Packet readData();
+        uint8_t getFlag(int index) const;
+        uint8_t getCurrentGearFromByte(void) const;
+        uint8_t getSuggestedGearFromByte(void) const;
+        uint8_t getPowertrainType(void) const;
+        float getTyreSpeed(int index) const;
+        float getTyreSlipRatio(int index) const;
+        void setIngestMode(IngestMode mode);
+        // Heartbeat sent and layout expected from now on, 'A' by default
+        void setPacketVariant(GT7PacketVariant variant);
+        GT7PacketVariant getPacketVariant() const;
+        // Validates and decrypts pending datagrams according to the ingest
+        // mode, returns false if no new packet was accepted (see getIngestStats())
+        bool readData();
+        // Latest accepted packet, valid until the next successful readData()
+        const Packet& getPacket() const;
+        const IngestStats& getIngestStats() const;
+        // Fills frame from the latest accepted packet
+        void decodeFrame(TelemetryFrame& frame) const;
     private: 
-        WiFiUDP Udp;
-        IPAddress remoteIP;
+        PacketSource* source = nullptr;
+        Salsa20Engine salsa20;
+        // One specialisation per layout, selected once per call through
+        // variantOps, so the per-field code has no variant checks
+        struct VariantOps {
+            char heartbeat;
+            bool (GT7_UDP_Parser::*readData)();
+            void (GT7_UDP_Parser::*decodeFrame)(TelemetryFrame& frame) const;
+        };
+        static const VariantOps variantOps[static_cast<size_t>(GT7PacketVariant::Count)];
+        GT7PacketVariant variant = GT7PacketVariant::A;
+        template <GT7PacketVariant V> int receiveHeader(uint8_t slot, uint8_t iv[8]);
+        template <GT7PacketVariant V> bool readDataAs();
+        template <GT7PacketVariant V> void decodeFrameAs(TelemetryFrame& frame) const;
+        // Front slot plus two back slots: the best candidate and the one being received
+        alignas(16) Packet slots[3] = {};
+        uint32_t slotReceivedMicros[3] = {};
+        uint8_t front = 0;
+        IngestMode ingestMode = IngestMode::Single;
+        bool hasPacket = false;
+        int32_t lastPacketId = 0;
+        IngestStats stats;
         std::array<uint8_t, 32> dKey;
         std::array<uint8_t, 32> getAsciiBytes(const std::string& inputString);
 };
@@ -0,0 +1,164 @@
+#include "HapticEvents.h"
+#include "GT7UDPParser.h"
+#include <math.h>
+
+static const HapticEnvelope envelopes[] = {
+    // frequency, amplitude, attack, hold, release
+    { 30, 0.6f, 2, 100, 30 },  // GearShift, frequency and hold from config
+    { 50, 0.4f, 2, 25, 15 },   // RevLimiter, one pulse per blink
+    { 35, 0.3f, 5, 40, 30 },   // TractionControl
+    { 35, 0.3f, 5, 40, 30 },   // StabilityControl
+    { 25, 0.5f, 5, 80, 60 },   // HandBrake
+};
+static_assert(sizeof(envelopes) / sizeof(envelopes[0]) == static_cast<size_t>(HapticEventType::Count), "one envelope per event type");
+
+HapticEnvelope getHapticEnvelope(HapticEventType type, const VibrationConfig& config) {
+    HapticEnvelope envelope = envelopes[static_cast<size_t>(type)];
+    if (type == HapticEventType::GearShift) {
+        envelope.frequency = static_cast<float>(config.gearShiftFrequency);
+        envelope.holdMs = static_cast<uint16_t>(config.gearShiftDuration);
+    }
+    return envelope;
+}
+
+static bool risingEdge(uint16_t previous, uint16_t current, SimulatorFlags flag) {
+    uint16_t mask = static_cast<uint16_t>(flag);
+    return (current & mask) != 0 && (previous & mask) == 0;
+}
+
+uint32_t HapticEventDetector::process(const TelemetryFrame& frame, HapticEventQueue& events) {
+    if (!initialized) {
+        initialized = true;
+        previousGear = frame.currentGear;
+        previousFlags = frame.flags;
+        return 0;
+    }
+
+    uint32_t dropped = 0;
+    auto fire = [&](HapticEventType type) {
+        dropped += events.push(type) ? 0 : 1;
+    };
+    if (frame.currentGear != previousGear) {
+        fire(HapticEventType::GearShift);
+    }
+    if (risingEdge(previousFlags, frame.flags, SimulatorFlags::RevLimiterBlinkAlertActive)) {
+        fire(HapticEventType::RevLimiter);
+    }
+    if (risingEdge(previousFlags, frame.flags, SimulatorFlags::TCSActive)) {
+        fire(HapticEventType::TractionControl);
+    }
+    if (risingEdge(previousFlags, frame.flags, SimulatorFlags::ASMActive)) {
+        fire(HapticEventType::StabilityControl);
+    }
+    if (risingEdge(previousFlags, frame.flags, SimulatorFlags::HandBrakeActive)) {
+        fire(HapticEventType::HandBrake);
+    }
+    previousGear = frame.currentGear;
+    previousFlags = frame.flags;
+    return dropped;
+}
+
+void HapticEventScheduler::begin(uint32_t sampleRate) {
+    this->sampleRate = static_cast<float>(sampleRate);
+    previousGain = 1;
+    for (Voice& voice : voices) {
+        voice.active = false;
+    }
+}
+
+void HapticEventScheduler::trigger(HapticEventType type, const VibrationConfig& config) {
+    // Free voice, otherwise the oldest one
+    Voice* voice = &voices[0];
+    for (Voice& candidate : voices) {
+        if (!candidate.active) {
+            voice = &candidate;
+            break;
+        }
+        if (candidate.age < voice->age) {
+            voice = &candidate;
+        }
+    }
+
+    HapticEnvelope envelope = getHapticEnvelope(type, config);
+    float w = 2.0f * static_cast<float>(M_PI) * envelope.frequency / sampleRate;
+    voice->k = 2.0f * cosf(w);
+    // Start values for the frequency the rounded k really produces, any
+    // other pair changes the amplitude (by 0.03% at 30 Hz)
+    double exact = acos(voice->k / 2.0);
+    voice->y1 = static_cast<float>(-sin(exact));
+    voice->y2 = static_cast<float>(-sin(2.0 * exact));
+    voice->peak = envelope.amplitude;
+    voice->attackLeft = static_cast<uint32_t>(envelope.attackMs * sampleRate / 1000) + 1;
+    voice->holdLeft = static_cast<uint32_t>(envelope.holdMs * sampleRate / 1000);
+    voice->releaseLeft = static_cast<uint32_t>(envelope.releaseMs * sampleRate / 1000) + 1;
+    voice->attackStep = voice->peak / voice->attackLeft;
+    voice->releaseStep = voice->peak / voice->releaseLeft;
+    voice->level = 0;
+    voice->age = ++triggerCount;
+    voice->active = true;
+}
+
+float HapticEventScheduler::peakLevel(size_t frames) const {
+    float level = 0;
+    for (const Voice& voice : voices) {
+        if (!voice.active) {
+            continue;
+        }
+        if (voice.attackLeft > frames) {
+            level += voice.level + voice.attackStep * frames;
+        } else if (voice.attackLeft > 0 || voice.holdLeft > 0) {
+            level += voice.peak;
+        } else {
+            level += voice.level; // only falls from here
+        }
+    }
+    return level;
+}
+
+void HapticEventScheduler::mix(int16_t* samples, size_t frames, uint8_t channels, float gain) {
+    // A higher gain ramps in across the block, a lower one applies at once,
+    // as only that keeps the sum with the mixer's voices within full scale
+    const float startScale = (gain < previousGain ? gain : previousGain) * 32767.0f;
+    const float step = frames > 0 ? (gain * 32767.0f - startScale) / frames : 0;
+    previousGain = gain;
+    for (Voice& voice : voices) {
+        if (!voice.active) {
+            continue;
+        }
+        int16_t* out = samples;
+        float scale = startScale;
+        for (size_t i = 0; i < frames && voice.active; ++i, scale += step) {
+            // Envelope: attack -> hold -> release
+            if (voice.attackLeft > 0) {
+                voice.level += voice.attackStep;
+                --voice.attackLeft;
+            } else if (voice.holdLeft > 0) {
+                voice.level = voice.peak;
+                --voice.holdLeft;
+            } else if (voice.releaseLeft > 0) {
+                voice.level -= voice.releaseStep;
+                --voice.releaseLeft;
+            } else {
+                voice.active = false;
+                break;
+            }
+
+            float y = voice.k * voice.y1 - voice.y2;
+            voice.y2 = voice.y1;
+            voice.y1 = y;
+            int32_t burst = static_cast<int32_t>(y * voice.level * scale);
+            for (uint8_t c = 0; c < channels; ++c, ++out) {
+                int32_t mixed = *out + burst;
+                *out = static_cast<int16_t>(mixed > 32767 ? 32767 : (mixed < -32768 ? -32768 : mixed));
+            }
+        }
+    }
+}
+
+size_t HapticEventScheduler::getActiveVoices() const {
+    size_t active = 0;
+    for (const Voice& voice : voices) {
+        active += voice.active ? 1 : 0;
+    }
+    return active;
+}
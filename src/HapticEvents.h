@@ -0,0 +1,79 @@
+#ifndef HAPTICEVENTS_H
+#define HAPTICEVENTS_H
+
+#include <inttypes.h>
+#include <stddef.h>
+#include "SpscQueue.h"
+#include "TelemetryFrame.h"
+#include "VibrationConfig.h"
+
+// Short haptic effects (gear shift, rev limiter, ...) that play as an
+// attack/hold/release burst on top of the continuous vibration.
+enum class HapticEventType : uint8_t {
+    GearShift,
+    RevLimiter,
+    TractionControl,
+    StabilityControl,
+    HandBrake,
+    Count
+};
+
+struct HapticEnvelope {
+    float frequency;     // Hz
+    float amplitude;     // 0..1 of full scale
+    uint16_t attackMs;
+    uint16_t holdMs;
+    uint16_t releaseMs;
+};
+
+// Envelope for an event type, gear shifts follow gearShiftFrequency/Duration
+HapticEnvelope getHapticEnvelope(HapticEventType type, const VibrationConfig& config);
+
+typedef SpscQueue<HapticEventType, 16> HapticEventQueue;
+
+// Runs on every accepted packet in the ingest task, so no edge is missed
+// even when the audio task only sees every other frame.
+class HapticEventDetector {
+    public:
+        // Pushes one event per rising edge and returns how many events were
+        // dropped because the queue was full
+        uint32_t process(const TelemetryFrame& frame, HapticEventQueue& events);
+    private:
+        bool initialized = false;
+        uint8_t previousGear = 0;
+        uint16_t previousFlags = 0;
+};
+
+// Fixed pool of burst voices mixed into the audio block, no allocation and
+// no blocking. When all voices are busy the oldest one is replaced.
+class HapticEventScheduler {
+    public:
+        static constexpr size_t MAX_VOICES = 4;
+
+        void begin(uint32_t sampleRate);
+        void trigger(HapticEventType type, const VibrationConfig& config);
+        // Highest envelope level (0..1, summed over the active bursts) the
+        // next mix() of that many frames reaches, for HapticMixer::setOverlayLevel()
+        float peakLevel(size_t frames) const;
+        // Adds all active bursts, scaled by gain, to the interleaved block
+        void mix(int16_t* samples, size_t frames, uint8_t channels, float gain);
+        size_t getActiveVoices() const;
+
+    private:
+        struct Voice {
+            bool active;
+            uint32_t age;
+            // Recursive sine oscillator: y[n] = k * y[n-1] - y[n-2]
+            float k, y1, y2;
+            float level, peak;   // envelope, 0..1 of full scale
+            float attackStep, releaseStep;
+            uint32_t attackLeft, holdLeft, releaseLeft;
+        };
+
+        float sampleRate = 32000;
+        float previousGain = 1;
+        uint32_t triggerCount = 0;
+        Voice voices[MAX_VOICES] = {};
+};
+
+#endif
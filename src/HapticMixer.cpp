@@ -0,0 +1,186 @@
+#include "HapticMixer.h"
+#include <math.h>
+
+// Left free next to an overlay: voices and overlay are rounded to 16 bits
+// separately, and a recursive burst oscillator drifts by about 1e-4
+static const float OVERLAY_MARGIN = 8 / 32767.0f;
+
+static float clampUnit(float value) {
+    return value < 0 ? 0 : (value > 1 ? 1 : value);
+}
+
+void HapticMixer::begin(uint32_t sampleRate) {
+    this->sampleRate = sampleRate;
+    for (Voice& voice : voices) {
+        voice = Voice();
+        for (float& weight : voice.pan) {
+            weight = 1;
+        }
+    }
+    headroomGain = 1;
+    overlayLevel = 0;
+    overlayGain = 1;
+}
+
+bool HapticMixer::attach(size_t voice, ToneGenerator& tone) {
+    if (voice >= MAX_VOICES) {
+        return false;
+    }
+    tone.begin(sampleRate);
+    tone.setFrequency(0);
+    voices[voice].tone = &tone;
+    return true;
+}
+
+void HapticMixer::setVoice(size_t voice, float frequency, float amplitude, float gain) {
+    if (voice >= MAX_VOICES || voices[voice].tone == nullptr) {
+        return;
+    }
+    Voice& v = voices[voice];
+    // A tone at 0 Hz is DC, not silence: fade out at the last frequency instead
+    if (frequency > 0) {
+        v.targetFrequency = frequency;
+        v.targetLevel = clampUnit(amplitude) * clampUnit(gain);
+    } else {
+        v.targetLevel = 0;
+    }
+}
+
+void HapticMixer::setVoicePan(size_t voice, const float weights[MAX_CHANNELS]) {
+    if (voice >= MAX_VOICES) {
+        return;
+    }
+    for (size_t c = 0; c < MAX_CHANNELS; ++c) {
+        voices[voice].pan[c] = clampUnit(weights[c]);
+    }
+}
+
+void HapticMixer::setMono(bool mono) {
+    this->mono = mono;
+}
+
+bool HapticMixer::isMono() const {
+    return mono;
+}
+
+float HapticMixer::getHeadroomGain() const {
+    return headroomGain;
+}
+
+void HapticMixer::setOverlayLevel(float level) {
+    overlayLevel = level > 0 ? level : 0;
+}
+
+float HapticMixer::getOverlayGain() const {
+    return overlayGain;
+}
+
+void HapticMixer::render(int16_t* samples, size_t frames, uint8_t channels) {
+    // The overlay is added to the whole call at once, it gets the smallest
+    // gain of all blocks
+    overlayGain = 1;
+    while (frames > 0) {
+        size_t n = frames < MAX_BLOCK_FRAMES ? frames : MAX_BLOCK_FRAMES;
+        renderBlock(samples, n, channels);
+        samples += n * channels;
+        frames -= n;
+    }
+}
+
+void HapticMixer::renderBlock(int16_t* samples, size_t frames, uint8_t channels) {
+    // Mono (or a single output): mix channel 0 only and copy it at the end
+    const size_t mixChannels = mono || channels < MAX_CHANNELS ? 1 : MAX_CHANNELS;
+
+    // Control rate: one smoothing step per block
+    float alpha = 1 - expf(-1000.0f * frames / (SMOOTHING_MS * sampleRate));
+    float total[MAX_CHANNELS] = {};
+    int32_t startTotal[MAX_CHANNELS] = {};
+    for (Voice& voice : voices) {
+        if (voice.tone == nullptr) {
+            continue;
+        }
+        for (size_t c = 0; c < mixChannels; ++c) {
+            startTotal[c] += voice.scale[c];
+        }
+        if (voice.frequency <= 0) {
+            voice.frequency = voice.targetFrequency; // no glide up from 0 Hz
+        }
+        voice.frequency += (voice.targetFrequency - voice.frequency) * alpha;
+        for (size_t c = 0; c < mixChannels; ++c) {
+            float target = voice.targetLevel * (mixChannels == 1 ? 1 : voice.pan[c]);
+            voice.level[c] += (target - voice.level[c]) * alpha;
+            total[c] += voice.level[c];
+        }
+    }
+    // Headroom: scale all voices down together if their sum exceeds full
+    // scale in the loudest channel, so the balance between channels stays
+    float loudest = 0;
+    int32_t loudestStart = 0;
+    for (size_t c = 0; c < mixChannels; ++c) {
+        loudest = total[c] > loudest ? total[c] : loudest;
+        loudestStart = startTotal[c] > loudestStart ? startTotal[c] : loudestStart;
+    }
+    loudest += overlayLevel;
+    headroomGain = loudest > 1 ? 1 / loudest : 1;
+
+    // Within the block each voice ramps from its scale at the end of the last
+    // block to the new one, so the overlay gets what the voices leave at both
+    // ends. That start did not yet make room for an overlay that begins now.
+    if (overlayLevel > 0) {
+        float voicesEnd = (loudest - overlayLevel) * headroomGain;
+        float voicesStart = loudestStart / 32767.0f;
+        float voicesMax = voicesStart > voicesEnd ? voicesStart : voicesEnd;
+        float gain = (1 - OVERLAY_MARGIN - voicesMax) / overlayLevel;
+        gain = gain > 0 ? gain : 0;
+        overlayGain = gain < overlayGain ? gain : overlayGain;
+    }
+
+    // Q15 scales adding up to at most 1.0 at both ends of the block, and so
+    // everywhere in between, so the int32 sum cannot overflow
+    for (size_t c = 0; c < mixChannels; ++c) {
+        for (size_t i = 0; i < frames; ++i) {
+            mixBlock[c][i] = 0;
+        }
+    }
+    for (Voice& voice : voices) {
+        if (voice.tone == nullptr) {
+            continue;
+        }
+        int32_t start[MAX_CHANNELS];
+        int32_t end[MAX_CHANNELS];
+        bool silent = true;
+        for (size_t c = 0; c < mixChannels; ++c) {
+            start[c] = voice.scale[c];
+            end[c] = static_cast<int32_t>(voice.level[c] * headroomGain * 32767.0f);
+            voice.scale[c] = end[c];
+            silent &= start[c] == 0 && end[c] == 0;
+        }
+        if (silent) {
+            continue;
+        }
+        voice.tone->setFrequency(voice.frequency);
+        voice.tone->render(voiceBlock, frames, 1);
+        for (size_t c = 0; c < mixChannels; ++c) {
+            // Linear ramp with 8 fractional bits on top of Q15
+            int32_t scale = start[c] * 256;
+            int32_t step = (end[c] - start[c]) * 256 / static_cast<int32_t>(frames);
+            int32_t* mix = mixBlock[c];
+            for (size_t i = 0; i < frames; ++i) {
+                mix[i] += voiceBlock[i] * (scale >> 8);
+                scale += step;
+            }
+        }
+    }
+
+    // Interleave, channels beyond the mixed ones repeat the last mixed one
+    for (size_t i = 0; i < frames; ++i) {
+        int16_t sample = 0;
+        for (uint8_t c = 0; c < channels; ++c) {
+            if (c < mixChannels) {
+                int32_t mixed = mixBlock[c][i] >> 15;
+                sample = static_cast<int16_t>(mixed > 32767 ? 32767 : (mixed < -32768 ? -32768 : mixed));
+            }
+            *samples++ = sample;
+        }
+    }
+}
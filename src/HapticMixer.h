@@ -0,0 +1,76 @@
+#ifndef HAPTICMIXER_H
+#define HAPTICMIXER_H
+
+#include <inttypes.h>
+#include <stddef.h>
+#include "Platform.h"
+
+// Sums several independent tones (one per vibration effect) into one block.
+// Each voice has its own frequency, amplitude (0..1, effect strength) and
+// gain (0..1, user intensity). When the scaled voices add up to more than
+// full scale, all of them are turned down by the same factor for that block,
+// so two strong effects never clip. Signals added to the block after
+// render() (the haptic bursts) announce their peak level beforehand with
+// setOverlayLevel(); it counts towards that sum, and getOverlayGain() says
+// how far they have to be turned down to fit as well.
+//
+// Every voice is synthesised once in mono and then weighted into up to
+// MAX_CHANNELS output channels (e.g. left/right shaker), the rendered block
+// stays interleaved. In mono mode only one channel is mixed and copied to
+// all outputs at the end.
+//
+// Parameters are control rate: setVoice() only sets targets. Once per block
+// the mixer moves frequency and level exponentially towards them and ramps
+// linearly across the block, so packet timing never shows up as steps.
+class HapticMixer {
+    public:
+        static constexpr size_t MAX_VOICES = 6;
+        static constexpr size_t MAX_CHANNELS = 2;
+        // Longer render() calls are split into blocks of this size
+        static constexpr size_t MAX_BLOCK_FRAMES = 256;
+        // Time constant of the control smoothing
+        static constexpr float SMOOTHING_MS = 20;
+
+        void begin(uint32_t sampleRate);
+        // Starts tone at the mixer sample rate and assigns it to voice
+        bool attach(size_t voice, ToneGenerator& tone);
+        void setVoice(size_t voice, float frequency, float amplitude, float gain);
+        // Weight (0..1) of the voice in each output channel, 1 for all by
+        // default; ignored in mono mode
+        void setVoicePan(size_t voice, const float weights[MAX_CHANNELS]);
+        void setMono(bool mono);
+        bool isMono() const;
+        void render(int16_t* samples, size_t frames, uint8_t channels);
+        // Factor applied to all voices in the last block, 1 without limiting
+        float getHeadroomGain() const;
+        // Highest level (0..1 per burst, summed) that will be added to the
+        // output of the next render() calls, 0 by default
+        void setOverlayLevel(float level);
+        // Factor for that overlay in the last render() call, the sum with
+        // the voices then stays within full scale in every sample
+        float getOverlayGain() const;
+
+    private:
+        struct Voice {
+            ToneGenerator* tone;
+            float targetFrequency;
+            float targetLevel;   // amplitude * gain
+            float pan[MAX_CHANNELS];
+            float frequency;     // smoothed, 0 until the first target
+            float level[MAX_CHANNELS];  // smoothed targetLevel * pan
+            int32_t scale[MAX_CHANNELS]; // Q15 level * headroom at the end of the last block
+        };
+
+        void renderBlock(int16_t* samples, size_t frames, uint8_t channels);
+
+        uint32_t sampleRate = 32000;
+        Voice voices[MAX_VOICES] = {};
+        float headroomGain = 1;
+        float overlayLevel = 0;
+        float overlayGain = 1;
+        bool mono = true;
+        int16_t voiceBlock[MAX_BLOCK_FRAMES] = {};
+        int32_t mixBlock[MAX_CHANNELS][MAX_BLOCK_FRAMES] = {};
+};
+
+#endif
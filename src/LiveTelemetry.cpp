@@ -0,0 +1,69 @@
+#include "LiveTelemetry.h"
+#include <math.h>
+
+static int16_t quantizeValue(float value, float scale) {
+    float scaled = value * scale;
+    // Written so that NaN ends up as 0
+    if (!(scaled > -32767.0f)) {
+        return scaled < 0 ? -32767 : 0;
+    }
+    return scaled < 32767.0f ? static_cast<int16_t>(lrintf(scaled)) : 32767;
+}
+
+void LiveTelemetryEncoder::quantize(const TelemetryFrame& frame, const VibrationState& voices, int16_t values[LIVE_CHANNELS]) {
+    auto at = [&](LiveChannel channel, size_t offset) -> int16_t& {
+        return values[static_cast<size_t>(channel) + offset];
+    };
+    at(LiveChannel::Speed, 0) = quantizeValue(frame.speed, 10);
+    at(LiveChannel::Rpm, 0) = quantizeValue(frame.rpm, 1);
+    at(LiveChannel::Gear, 0) = static_cast<int16_t>(frame.currentGear | frame.suggestedGear << 8);
+    at(LiveChannel::Throttle, 0) = frame.throttle;
+    at(LiveChannel::Brake, 0) = frame.brake;
+    at(LiveChannel::Flags, 0) = static_cast<int16_t>(frame.flags);
+    for (size_t i = 0; i < 4; ++i) {
+        at(LiveChannel::TyreSlip, i) = quantizeValue(frame.tyreSlipRatio[i], 1000);
+        at(LiveChannel::SuspVelocity, i) = quantizeValue(frame.suspVelocity[i], 1000);
+        at(LiveChannel::RoadTexture, i) = quantizeValue(frame.roadTexture[i], 1000);
+    }
+    for (size_t v = 0; v < VIBRATION_VOICES; ++v) {
+        at(LiveChannel::VoiceFrequency, v) = quantizeValue(voices.frequency[v], 10);
+        at(LiveChannel::VoiceLevel, v) = quantizeValue(voices.level[v], 1000);
+    }
+}
+
+void LiveTelemetryEncoder::requestKeyFrame() {
+    keyFramePending = true;
+}
+
+size_t LiveTelemetryEncoder::encode(const int16_t values[LIVE_CHANNELS], uint8_t* out) {
+    bool keyFrame = keyFramePending || sinceKeyFrame >= KEY_FRAME_INTERVAL;
+    keyFramePending = false;
+    sinceKeyFrame = keyFrame ? 0 : sinceKeyFrame + 1;
+
+    uint32_t mask = 0;
+    size_t used = HEADER_BYTES;
+    for (size_t c = 0; c < LIVE_CHANNELS; ++c) {
+        int32_t delta = keyFrame ? values[c] : values[c] - previous[c];
+        if (!keyFrame && delta == 0) {
+            continue;
+        }
+        mask |= 1u << c;
+        uint32_t zigzag = (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+        while (zigzag >= 0x80) {
+            out[used++] = static_cast<uint8_t>(zigzag | 0x80);
+            zigzag >>= 7;
+        }
+        out[used++] = static_cast<uint8_t>(zigzag);
+        previous[c] = values[c];
+    }
+
+    out[0] = keyFrame ? 1 : 0;
+    out[1] = static_cast<uint8_t>(LIVE_CHANNELS);
+    out[2] = static_cast<uint8_t>(sequence);
+    out[3] = static_cast<uint8_t>(sequence >> 8);
+    for (int i = 0; i < 4; ++i) {
+        out[4 + i] = static_cast<uint8_t>(mask >> (8 * i));
+    }
+    ++sequence;
+    return used;
+}
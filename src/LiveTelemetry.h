@@ -0,0 +1,61 @@
+#ifndef LIVETELEMETRY_H
+#define LIVETELEMETRY_H
+
+#include <inttypes.h>
+#include <stddef.h>
+#include "TelemetryFrame.h"
+#include "VibrationEngine.h"
+
+// Channels of the live view, each quantised to int16 (scale in brackets).
+// The web UI decodes them in this order, keep both in step.
+enum class LiveChannel : uint8_t {
+    Speed,                                  // km/h (x10)
+    Rpm,                                    // (x1)
+    Gear,                                   // current gear | suggested gear << 8
+    Throttle,                               // 0..255
+    Brake,                                  // 0..255
+    Flags,                                  // SimulatorFlags
+    TyreSlip,                               // tyre speed / car speed per wheel (x1000)
+    SuspVelocity = TyreSlip + 4,            // m/s per wheel (x1000)
+    RoadTexture = SuspVelocity + 4,         // m/s per wheel (x1000)
+    VoiceFrequency = RoadTexture + 4,       // Hz per VibrationVoice (x10)
+    VoiceLevel = VoiceFrequency + VIBRATION_VOICES, // 0..1 per VibrationVoice (x1000)
+    Count = VoiceLevel + VIBRATION_VOICES
+};
+
+constexpr size_t LIVE_CHANNELS = static_cast<size_t>(LiveChannel::Count);
+static_assert(LIVE_CHANNELS <= 32, "the channel mask is 32 bits");
+
+// Binary live-telemetry frames for the WebSocket view. Little endian:
+//
+//   u8  flags      bit 0: key frame
+//   u8  channels   LIVE_CHANNELS
+//   u16 sequence   +1 per frame, gaps mean the receiver missed frames
+//   u32 mask       bit n: channel n follows
+//   per set bit    zigzag varint of the change to the previous frame
+//                  (key frames: of the value itself)
+//
+// Only channels that changed are sent, a frame with nothing moving is 8
+// bytes. A key frame with every channel goes out every KEY_FRAME_INTERVAL
+// frames and whenever requested (new client), so a receiver can join at
+// any point.
+class LiveTelemetryEncoder {
+    public:
+        static constexpr size_t HEADER_BYTES = 8;
+        static constexpr size_t MAX_FRAME_BYTES = HEADER_BYTES + LIVE_CHANNELS * 3;
+        static constexpr uint16_t KEY_FRAME_INTERVAL = 40;
+
+        static void quantize(const TelemetryFrame& frame, const VibrationState& voices, int16_t values[LIVE_CHANNELS]);
+
+        // Writes the next frame to out (MAX_FRAME_BYTES), returns its length
+        size_t encode(const int16_t values[LIVE_CHANNELS], uint8_t* out);
+        void requestKeyFrame();
+
+    private:
+        int16_t previous[LIVE_CHANNELS] = {};
+        uint16_t sequence = 0;
+        uint16_t sinceKeyFrame = 0;
+        bool keyFramePending = true;
+};
+
+#endif
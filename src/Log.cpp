@@ -0,0 +1,141 @@
+#include "Log.h"
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of two");
+
+// Bounded multi-producer ring (ingest, audio and web task all log), single
+// consumer. Each cell carries a sequence number telling whose turn it is,
+// stored relative to the cell index so the zero-initialised ring is empty.
+struct LogCell {
+    std::atomic<uint32_t> sequence;
+    LogRecord record;
+};
+
+static LogCell cells[LOG_RING_SIZE];
+static std::atomic<uint32_t> enqueuePos{0};
+static uint32_t dequeuePos = 0;
+static std::atomic<uint32_t> dropped{0};
+static std::atomic<bool> running{false};
+
+void logWrite(const LogRecord& record) {
+    uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        uint32_t index = pos & (LOG_RING_SIZE - 1);
+        LogCell& cell = cells[index];
+        int32_t diff = static_cast<int32_t>(cell.sequence.load(std::memory_order_acquire) + index - pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.record = record;
+                cell.sequence.store(pos + 1 - index, std::memory_order_release);
+                return;
+            }
+        } else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+static bool logRead(LogRecord& record) {
+    uint32_t index = dequeuePos & (LOG_RING_SIZE - 1);
+    LogCell& cell = cells[index];
+    if (cell.sequence.load(std::memory_order_acquire) + index != dequeuePos + 1) {
+        return false;
+    }
+    record = cell.record;
+    cell.sequence.store(dequeuePos + LOG_RING_SIZE - index, std::memory_order_release);
+    ++dequeuePos;
+    return true;
+}
+
+uint32_t logDropped() {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+// Formats one conversion at a time with the type that was captured, length
+// modifiers in the format are ignored since all integers are stored as 32 bit
+static size_t formatRecord(const LogRecord& record, char* line, size_t size) {
+    static const char levels[] = "-EWID";
+    int used = snprintf(line, size, "%c %" PRIu32 ".%03" PRIu32 " ", levels[record.level < 5 ? record.level : 0],
+                        record.micros / 1000000, record.micros / 1000 % 1000);
+    size_t n = used > 0 ? static_cast<size_t>(used) : 0;
+    uint8_t arg = 0;
+    for (const char* f = record.format; *f != '\0' && n + 1 < size; ++f) {
+        if (*f != '%') {
+            line[n++] = *f;
+            continue;
+        }
+        if (f[1] == '%') {
+            line[n++] = '%';
+            ++f;
+            continue;
+        }
+        char spec[16];
+        size_t s = 0;
+        spec[s++] = *f++;
+        while (*f != '\0' && strchr("diouxXcsfFeEgGp", *f) == nullptr) {
+            if (strchr("hlLqjzt", *f) == nullptr && s + 2 < sizeof(spec)) {
+                spec[s++] = *f;
+            }
+            ++f;
+        }
+        if (*f == '\0') {
+            break;
+        }
+        spec[s++] = *f;
+        spec[s] = '\0';
+        if (arg >= record.argCount) {
+            continue;
+        }
+        const LogArg& value = record.args[arg];
+        switch (record.types[arg++]) {
+            case LogArgType::Int: used = snprintf(line + n, size - n, spec, value.i); break;
+            case LogArgType::Unsigned: used = snprintf(line + n, size - n, spec, value.u); break;
+            case LogArgType::Float: used = snprintf(line + n, size - n, spec, static_cast<double>(value.f)); break;
+            case LogArgType::String: used = snprintf(line + n, size - n, spec, value.s); break;
+        }
+        if (used > 0) {
+            n += static_cast<size_t>(used);
+        }
+    }
+    n = n < size ? n : size - 1;
+    line[n] = '\0';
+    return n;
+}
+
+static void flushTask(void*) {
+    char line[128];
+    uint32_t reportedDrops = 0;
+    for (;;) {
+        // Checked before draining, so everything logged before logStop() is printed
+        bool stopping = !running;
+        LogRecord record;
+        while (logRead(record)) {
+            formatRecord(record, line, sizeof(line));
+            logPrintf("%s", line);
+        }
+        uint32_t drops = logDropped();
+        if (drops != reportedDrops) {
+            logPrintf("log: %" PRIu32 " records dropped\n", drops - reportedDrops);
+            reportedDrops = drops;
+        }
+        if (stopping) {
+            break;
+        }
+        clockDelay(10);
+    }
+    endTask();
+}
+
+bool logStart(uint8_t core) {
+    running = true;
+    return startTask("log", flushTask, nullptr, LOG_STACK_SIZE, LOG_PRIORITY, core);
+}
+
+void logStop() {
+    running = false;
+}
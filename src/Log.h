@@ -0,0 +1,125 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <type_traits>
+#include "Platform.h"
+
+// Deferred logging: LOG_* macros below LOG_LEVEL compile to nothing. The
+// others copy the format pointer and up to LOG_MAX_ARGS raw arguments into a
+// lock-free ring, which a low-priority task formats and prints. No formatting
+// and no Serial in the calling task; when the ring is full the record is
+// dropped and counted.
+//
+// The format must be a string literal and string arguments must outlive the
+// flush (literals or static buffers), only pointers are stored.
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+constexpr size_t LOG_MAX_ARGS = 4;
+constexpr size_t LOG_RING_SIZE = 64;   // records, power of two
+constexpr uint8_t LOG_PRIORITY = 1;
+constexpr uint32_t LOG_STACK_SIZE = 3072;
+
+enum class LogArgType : uint8_t { Int, Unsigned, Float, String };
+
+union LogArg {
+    int32_t i;
+    uint32_t u;
+    float f;
+    const char* s;
+};
+
+struct LogRecord {
+    const char* format;
+    uint32_t micros;
+    uint8_t level;
+    uint8_t argCount;
+    LogArgType types[LOG_MAX_ARGS];
+    LogArg args[LOG_MAX_ARGS];
+};
+
+// Starts the flush task on core
+bool logStart(uint8_t core);
+// Lets the flush task print what is left and return, only needed by the host build
+void logStop();
+// Records lost because the ring was full
+uint32_t logDropped();
+void logWrite(const LogRecord& record);
+
+inline void logCapture(LogRecord&) {}
+
+template <typename T, typename... Rest>
+inline void logCapture(LogRecord& record, T value, Rest... rest) {
+    uint8_t n = record.argCount++;
+    if constexpr (std::is_floating_point<T>::value) {
+        record.types[n] = LogArgType::Float;
+        record.args[n].f = static_cast<float>(value);
+    } else if constexpr (std::is_pointer<T>::value) {
+        record.types[n] = LogArgType::String;
+        record.args[n].s = value;
+    } else if constexpr (std::is_signed<T>::value) {
+        record.types[n] = LogArgType::Int;
+        record.args[n].i = static_cast<int32_t>(value);
+    } else {
+        record.types[n] = LogArgType::Unsigned;
+        record.args[n].u = static_cast<uint32_t>(value);
+    }
+    logCapture(record, rest...);
+}
+
+template <typename... Args>
+inline void logRecord(uint8_t level, const char* format, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+    LogRecord record;
+    record.format = format;
+    record.micros = clockMicros();
+    record.level = level;
+    record.argCount = 0;
+    logCapture(record, args...);
+    logWrite(record);
+}
+
+// Never called, only lets the compiler check format against the arguments
+inline void logFormatCheck(const char*, ...) __attribute__((format(printf, 1, 2)));
+inline void logFormatCheck(const char*, ...) {}
+
+#define LOG_AT(level, format, ...) do { \
+        if (false) logFormatCheck(format, ##__VA_ARGS__); \
+        logRecord(level, format, ##__VA_ARGS__); \
+    } while (0)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(format, ...) LOG_AT(LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(format, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(format, ...) LOG_AT(LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#else
+#define LOG_WARN(format, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(format, ...) LOG_AT(LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#else
+#define LOG_INFO(format, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(format, ...) LOG_AT(LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(format, ...) do {} while (0)
+#endif
+
+#endif
@@ -0,0 +1,82 @@
+#include "Metrics.h"
+#include <stdio.h>
+
+static uint32_t bucketFor(uint32_t value) {
+    if (value < 4) {
+        return value;
+    }
+    uint32_t msb = 31 - __builtin_clz(value);
+    return (msb - 1) * 4 + ((value >> (msb - 2)) & 3);
+}
+
+static uint64_t bucketLowerBound(uint32_t bucket) {
+    if (bucket < 4) {
+        return bucket;
+    }
+    uint32_t msb = bucket / 4 + 1;
+    return static_cast<uint64_t>(4 + bucket % 4) << (msb - 2);
+}
+
+void Histogram::record(uint32_t value) {
+    // Single writer: plain load and store instead of read-modify-write
+    std::atomic<uint32_t>& bucket = buckets[bucketFor(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (value > max.load(std::memory_order_relaxed)) {
+        max.store(value, std::memory_order_relaxed);
+    }
+}
+
+uint32_t Histogram::getCount() const {
+    return count.load(std::memory_order_relaxed);
+}
+
+uint32_t Histogram::getMax() const {
+    return max.load(std::memory_order_relaxed);
+}
+
+uint32_t Histogram::getQuantile(float q) const {
+    uint32_t total = getCount();
+    if (total == 0) {
+        return 0;
+    }
+    uint32_t rank = static_cast<uint32_t>(q * total);
+    rank = rank < total ? rank : total - 1;
+    uint32_t seen = 0;
+    for (uint32_t i = 0; i < BUCKETS; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen > rank) {
+            uint64_t upper = bucketLowerBound(i + 1) - 1;
+            uint32_t highest = getMax();
+            return upper < highest ? static_cast<uint32_t>(upper) : highest;
+        }
+    }
+    return getMax();
+}
+
+static size_t append(size_t size, size_t used, int written) {
+    if (written < 0) {
+        return used;
+    }
+    used += static_cast<size_t>(written);
+    return used < size ? used : size - 1;
+}
+
+size_t formatSummary(char* buffer, size_t size, size_t used, const char* name, const Histogram& histogram, float divisor) {
+    used = append(size, used, snprintf(buffer + used, size - used,
+        "# TYPE %s summary\n"
+        "%s{quantile=\"0.5\"} %.1f\n"
+        "%s{quantile=\"0.99\"} %.1f\n"
+        "%s_max %.1f\n"
+        "%s_count %" PRIu32 "\n",
+        name,
+        name, histogram.getQuantile(0.5f) / divisor,
+        name, histogram.getQuantile(0.99f) / divisor,
+        name, histogram.getMax() / divisor,
+        name, histogram.getCount()));
+    return used;
+}
+
+size_t formatValue(char* buffer, size_t size, size_t used, const char* name, const char* type, double value) {
+    return append(size, used, snprintf(buffer + used, size - used, "# TYPE %s %s\n%s %.10g\n", name, type, name, value));
+}
@@ -0,0 +1,32 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <inttypes.h>
+#include <stddef.h>
+
+// Fixed-bucket histogram, four buckets per power of two (values are reported
+// with at most 25 % error). One writer task, any number of readers; record()
+// is a handful of instructions and never allocates.
+class Histogram {
+    public:
+        static constexpr size_t BUCKETS = 124;
+
+        void record(uint32_t value);
+        uint32_t getCount() const;
+        uint32_t getMax() const;
+        // Upper bound of the bucket holding quantile q (0..1), capped at max
+        uint32_t getQuantile(float q) const;
+
+    private:
+        std::atomic<uint32_t> buckets[BUCKETS] = {};
+        std::atomic<uint32_t> count{0};
+        std::atomic<uint32_t> max{0};
+};
+
+// Appends to a text buffer in the Prometheus exposition format, so /metrics
+// can be scraped as is. All of them return the new used length.
+size_t formatSummary(char* buffer, size_t size, size_t used, const char* name, const Histogram& histogram, float divisor);
+size_t formatValue(char* buffer, size_t size, size_t used, const char* name, const char* type, double value);
+
+#endif
@@ -0,0 +1,104 @@
+#include "PacketCapture.h"
+#include <string.h>
+
+bool CapturingPacketSource::begin(uint16_t localPort) {
+    CaptureFileHeader header = { CAPTURE_MAGIC, CAPTURE_VERSION, 0 };
+    if (!storage.append(reinterpret_cast<const uint8_t*>(&header), sizeof(header))) {
+        ++failed;
+    }
+    return source.begin(localPort);
+}
+
+int CapturingPacketSource::receive(uint8_t* buffer, size_t capacity) {
+    int length = source.receive(buffer, capacity);
+    if (length <= 0) {
+        return length;
+    }
+    size_t stored = static_cast<size_t>(length) < capacity ? static_cast<size_t>(length) : capacity;
+    CaptureRecordHeader record = { clockMicros(), static_cast<uint16_t>(length), static_cast<uint16_t>(stored) };
+    // A failed append loses this record only, the next one starts clean
+    if (storage.append(reinterpret_cast<const uint8_t*>(&record), sizeof(record)) && storage.append(buffer, stored)) {
+        ++captured;
+    } else {
+        ++failed;
+    }
+    return length;
+}
+
+void CapturingPacketSource::send(uint16_t remotePort, const uint8_t* data, size_t length) {
+    source.send(remotePort, data, length);
+}
+
+bool ReplayPacketSource::begin(uint16_t) {
+    CaptureFileHeader header;
+    if (size < sizeof(header)) {
+        offset = size;
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != CAPTURE_MAGIC || header.version != CAPTURE_VERSION) {
+        offset = size;
+        return false;
+    }
+    offset = sizeof(header);
+    started = false;
+    replayed = 0;
+    return true;
+}
+
+uint16_t ReplayPacketSource::peekLength() const {
+    CaptureRecordHeader record;
+    if (offset + sizeof(record) > size) {
+        return 0;
+    }
+    memcpy(&record, data + offset, sizeof(record));
+    return record.length;
+}
+
+void ReplayPacketSource::setVirtualTime(uint32_t micros) {
+    virtualClock = true;
+    virtualMicros = micros;
+}
+
+int ReplayPacketSource::receive(uint8_t* buffer, size_t capacity) {
+    CaptureRecordHeader record;
+    if (offset + sizeof(record) > size) {
+        offset = size;
+        return 0;
+    }
+    memcpy(&record, data + offset, sizeof(record));
+    if (offset + sizeof(record) + record.stored > size) {
+        offset = size; // cut off while recording
+        return 0;
+    }
+
+    // Keep the recorded spacing, scaled by speed, relative to the first record
+    uint32_t now = clockMicros();
+    if (!started) {
+        started = true;
+        firstMicros = record.micros;
+        startMicros = now;
+    }
+    if (virtualClock) {
+        if (virtualMicros < record.micros - firstMicros) {
+            return 0;
+        }
+    } else if (speed > 0) {
+        uint32_t due = static_cast<uint32_t>((record.micros - firstMicros) / speed);
+        if (now - startMicros < due) {
+            return 0;
+        }
+    }
+
+    offset += sizeof(record);
+    size_t copied = record.stored < capacity ? record.stored : capacity;
+    memcpy(buffer, data + offset, copied);
+    offset += record.stored;
+    ++replayed;
+    // Longer than capacity, or cut off when it was recorded with a smaller
+    // one: the datagram is not in the buffer as a whole, see PacketSource
+    if (record.length > capacity || copied < record.length) {
+        return static_cast<int>(capacity) + 1;
+    }
+    return record.length;
+}
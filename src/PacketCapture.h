@@ -0,0 +1,87 @@
+#ifndef PACKETCAPTURE_H
+#define PACKETCAPTURE_H
+
+#include "Platform.h"
+
+// Capture file: an 8 byte file header followed by one record per received
+// datagram, still encrypted, appended in arrival order:
+//
+//   CaptureFileHeader   "GT7C", version
+//   CaptureRecordHeader receive time (clockMicros), original and stored length
+//   payload             stored bytes
+//
+// All fields little endian, records are not padded.
+constexpr uint32_t CAPTURE_MAGIC = 0x43375447; // "GT7C"
+constexpr uint16_t CAPTURE_VERSION = 1;
+
+#pragma pack(push, 1)
+struct CaptureFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+};
+
+struct CaptureRecordHeader {
+    uint32_t micros;
+    uint16_t length;   // as reported by the source, capacity + 1 if truncated
+    uint16_t stored;   // payload bytes that follow
+};
+#pragma pack(pop)
+
+// Append-only byte storage for a capture (file on the host, flash on the ESP32)
+class CaptureStorage {
+    public:
+        virtual ~CaptureStorage() = default;
+        virtual bool append(const uint8_t* data, size_t length) = 0;
+};
+
+// Passes everything through to source and appends each received datagram to
+// storage. Sits between the parser and the socket, so the capture holds
+// exactly what the parser saw.
+class CapturingPacketSource : public PacketSource {
+    public:
+        CapturingPacketSource(PacketSource& source, CaptureStorage& storage) : source(source), storage(storage) {}
+        bool begin(uint16_t localPort) override;
+        int receive(uint8_t* buffer, size_t capacity) override;
+        void send(uint16_t remotePort, const uint8_t* data, size_t length) override;
+        uint32_t getCaptured() const { return captured; }
+        uint32_t getFailed() const { return failed; }
+    private:
+        PacketSource& source;
+        CaptureStorage& storage;
+        uint32_t captured = 0;
+        uint32_t failed = 0;
+};
+
+// Feeds a capture held in memory (e.g. a memory-mapped file) back as if it
+// arrived from the network. speed 1 replays in real time, 4 four times
+// faster, 0 as fast as the parser reads. Heartbeats are ignored.
+class ReplayPacketSource : public PacketSource {
+    public:
+        ReplayPacketSource(const uint8_t* data, size_t size, float speed = 1) : data(data), size(size), speed(speed) {}
+        // Fails on a missing or unknown file header
+        bool begin(uint16_t localPort) override;
+        int receive(uint8_t* buffer, size_t capacity) override;
+        void send(uint16_t, const uint8_t*, size_t) override {}
+        // Switches pacing from the wall clock to the given capture time,
+        // microseconds since the first record (offline rendering)
+        void setVirtualTime(uint32_t micros);
+        // All records delivered, or the rest of the capture is damaged
+        bool finished() const { return offset >= size; }
+        // Original length of the next datagram, 0 at the end
+        uint16_t peekLength() const;
+        uint32_t getReplayed() const { return replayed; }
+    private:
+        const uint8_t* data;
+        size_t size;
+        float speed;
+        size_t offset = 0;
+        bool started = false;
+        uint32_t firstMicros = 0;
+        uint32_t startMicros = 0;
+        uint32_t replayed = 0;
+        bool virtualClock = false;
+        uint32_t virtualMicros = 0;
+};
+
+#endif
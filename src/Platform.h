@@ -0,0 +1,71 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+// Thin hardware abstraction layer. Everything above this header (parser,
+// Salsa20, vibration engine) is platform independent; the ESP32 firmware
+// implements it in esp32/, the Linux host target in native/.
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// Monotonic clock
+uint32_t clockMillis();
+uint32_t clockMicros();
+void clockDelay(uint32_t ms);
+// CPU cycle counter for stage timing. Per core on the ESP32, so only compare
+// values taken in the same task; nanoseconds on the host.
+uint32_t clockCycles();
+uint32_t clockCyclesPerMicro();
+
+// Free heap in bytes, 0 where the platform has no fixed heap (host)
+size_t freeHeap();
+
+// Starts a task running forever, pinned to core where the platform supports it.
+// FreeRTOS on the ESP32, std::thread on the host.
+bool startTask(const char* name, void (*task)(void*), void* arg, uint32_t stackSize, uint8_t priority, uint8_t core);
+// Must end every task function that returns
+void endTask();
+
+// Diagnostic output (Serial on the ESP32, stderr on the host)
+void logPrintf(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+// Datagram transport towards the PlayStation
+class PacketSource {
+    public:
+        virtual ~PacketSource() = default;
+        virtual bool begin(uint16_t localPort) = 0;
+        // Copies the next pending datagram into buffer and returns its length,
+        // 0 if nothing is pending. A datagram that does not fit is cut to
+        // capacity bytes and reported as capacity + 1, never as capacity, so
+        // the caller can tell it from one of exactly that size.
+        virtual int receive(uint8_t* buffer, size_t capacity) = 0;
+        virtual void send(uint16_t remotePort, const uint8_t* data, size_t length) = 0;
+};
+
+// Interleaved signed 16-bit PCM output
+class AudioSink {
+    public:
+        virtual ~AudioSink() = default;
+        virtual bool begin(uint32_t sampleRate, uint8_t channels) = 0;
+        // Returns the number of frames accepted
+        virtual size_t write(const int16_t* samples, size_t frames) = 0;
+        // Blocks that arrived after the output had already run dry
+        virtual uint32_t getUnderruns() const { return 0; }
+};
+
+// Tone source driven by the vibration engine
+class ToneGenerator {
+    public:
+        virtual ~ToneGenerator() = default;
+        virtual void begin(uint32_t sampleRate) = 0;
+        // May glide to the new frequency over the next render() call
+        virtual void setFrequency(float frequency) = 0;
+        // Renders frames and duplicates each sample across all channels
+        virtual void render(int16_t* samples, size_t frames, uint8_t channels) = 0;
+};
+
+#endif
@@ -0,0 +1,69 @@
+#include "RoadTextureDetector.h"
+#include "GT7UDPParser.h"
+#include <math.h>
+
+void RoadTextureDetector::configure(const RoadTextureConfig& config) {
+    this->config = config;
+    for (size_t b = 0; b < TEXTURE_BANDS; ++b) {
+        coefficients[b] = 2 * cosf(2 * static_cast<float>(M_PI) * config.bandHz[b] / gt7PacketRate);
+    }
+    // The window keeps leakage from the strong low frequency body motion
+    // out of the neighbouring bands
+    float windowSum = 0;
+    for (size_t n = 0; n < WINDOW; ++n) {
+        hann[n] = 0.5f - 0.5f * cosf(2 * static_cast<float>(M_PI) * n / WINDOW);
+        windowSum += hann[n];
+    }
+    amplitudeScale = 2 / windowSum;
+}
+
+void RoadTextureDetector::analyse(const float* samples, float amplitudes[TEXTURE_BANDS]) const {
+    float mean = 0;
+    for (size_t n = 0; n < WINDOW; ++n) {
+        mean += samples[n];
+    }
+    mean /= WINDOW;
+
+    // All bands in one pass over the samples
+    float s1[TEXTURE_BANDS] = {};
+    float s2[TEXTURE_BANDS] = {};
+    for (size_t n = 0; n < WINDOW; ++n) {
+        float x = (samples[n] - mean) * hann[n];
+        for (size_t b = 0; b < TEXTURE_BANDS; ++b) {
+            float s0 = x + coefficients[b] * s1[b] - s2[b];
+            s2[b] = s1[b];
+            s1[b] = s0;
+        }
+    }
+    for (size_t b = 0; b < TEXTURE_BANDS; ++b) {
+        float power = s1[b] * s1[b] + s2[b] * s2[b] - coefficients[b] * s1[b] * s2[b];
+        amplitudes[b] = amplitudeScale * sqrtf(power > 0 ? power : 0);
+    }
+}
+
+void RoadTextureDetector::process(const TelemetryHistory& history, TelemetryFrame& frame) const {
+    for (size_t b = 0; b < TEXTURE_BANDS; ++b) {
+        frame.textureBands[b] = 0;
+    }
+    if (history.size() < WINDOW) {
+        return;
+    }
+
+    static const HistoryChannel channels[] = {
+        wheelChannel(HistoryChannel::SuspHeight, 0), wheelChannel(HistoryChannel::SuspHeight, 1),
+        wheelChannel(HistoryChannel::SuspHeight, 2), wheelChannel(HistoryChannel::SuspHeight, 3),
+        HistoryChannel::RoadPlaneDistance
+    };
+    for (HistoryChannel channel : channels) {
+        float amplitudes[TEXTURE_BANDS];
+        analyse(history.window(channel, WINDOW), amplitudes);
+        for (size_t b = 0; b < TEXTURE_BANDS; ++b) {
+            frame.textureBands[b] = amplitudes[b] > frame.textureBands[b] ? amplitudes[b] : frame.textureBands[b];
+        }
+    }
+    for (size_t b = 0; b < TEXTURE_BANDS; ++b) {
+        if (frame.textureBands[b] < config.thresholdM) {
+            frame.textureBands[b] = 0;
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef ROADTEXTUREDETECTOR_H
+#define ROADTEXTUREDETECTOR_H
+
+#include <inttypes.h>
+#include <stddef.h>
+#include "TelemetryFrame.h"
+#include "TelemetryHistory.h"
+
+struct RoadTextureConfig {
+    // Excitation frequencies at packet rate: rough asphalt, kerbs, rumble strips
+    float bandHz[TEXTURE_BANDS] = { 6, 12, 20 };
+    float thresholdM = 0.0005f; // amplitudes below count as smooth road
+};
+
+// Picks up periodic road excitation (kerbs, rumble strips) that a single
+// height sample cannot tell apart from ride height. Once per accepted packet
+// a Goertzel filter per band runs over the newest WINDOW samples of the four
+// suspension heights and the road plane distance, straight on the history
+// columns: fixed cost, no FFT buffer. The band amplitude of the most excited
+// channel goes into frame.textureBands.
+// The bins assume one sample per packet. History only holds accepted
+// packets, so when latest-wins ingest supersedes some, the window spans
+// more than WINDOW packet periods and its samples are no longer evenly
+// spaced: an excitation reads slightly higher in frequency and leaks into
+// the neighbouring bands while those packets are in the window. Occasional
+// gaps only smear the bands a little, so they are not resampled here.
+class RoadTextureDetector {
+    public:
+        static constexpr size_t WINDOW = 32; // ~0.5 s, 1.9 Hz bins at 60 Hz
+
+        void configure(const RoadTextureConfig& config);
+        // frame must be the newest frame pushed into history
+        void process(const TelemetryHistory& history, TelemetryFrame& frame) const;
+
+    private:
+        void analyse(const float* samples, float amplitudes[TEXTURE_BANDS]) const;
+
+        RoadTextureConfig config;
+        float coefficients[TEXTURE_BANDS] = {}; // 2 cos(w) per band
+        float hann[WINDOW] = {};
+        float amplitudeScale = 0;               // power to amplitude of a sine
+};
+
+#endif
@@ -0,0 +1,162 @@
+#include "Salsa20Engine.h"
+#include <string.h>
+#ifdef ARDUINO
+#include <esp_attr.h>
+#else
+#define IRAM_ATTR
+#endif
+
+#if defined(__BYTE_ORDER__)
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "word-wise keystream XOR assumes little endian");
+#endif
+
+static inline uint32_t load32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline void store32(uint8_t* p, uint32_t value) {
+    memcpy(p, &value, sizeof(value));
+}
+
+// Works on uint32_t and on GCC vector types alike
+template <typename W>
+static inline W rotl(W value, int numBits) {
+    return (value << numBits) | (value >> (32 - numBits));
+}
+
+template <typename W>
+static inline void quarterRound(W& a, W& b, W& c, W& d) {
+    b ^= rotl<W>(a + d, 7);
+    c ^= rotl<W>(b + a, 9);
+    d ^= rotl<W>(c + b, 13);
+    a ^= rotl<W>(d + c, 18);
+}
+
+template <typename W>
+static inline void doubleRounds(W (&x)[16]) {
+    for (int i = 0; i < 10; ++i) {
+        // Column round
+        quarterRound(x[0], x[4], x[8], x[12]);
+        quarterRound(x[5], x[9], x[13], x[1]);
+        quarterRound(x[10], x[14], x[2], x[6]);
+        quarterRound(x[15], x[3], x[7], x[11]);
+        // Row round
+        quarterRound(x[0], x[1], x[2], x[3]);
+        quarterRound(x[5], x[6], x[7], x[4]);
+        quarterRound(x[10], x[11], x[8], x[9]);
+        quarterRound(x[15], x[12], x[13], x[14]);
+    }
+}
+
+void Salsa20Engine::setKey(const uint8_t key[KEY_SIZE]) {
+    static const uint8_t constants[] = "expand 32-byte k";
+
+    keySchedule[0] = load32(&constants[0]);
+    keySchedule[1] = load32(&key[0]);
+    keySchedule[2] = load32(&key[4]);
+    keySchedule[3] = load32(&key[8]);
+    keySchedule[4] = load32(&key[12]);
+    keySchedule[5] = load32(&constants[4]);
+    keySchedule[6] = keySchedule[7] = keySchedule[8] = keySchedule[9] = 0;
+    keySchedule[10] = load32(&constants[8]);
+    keySchedule[11] = load32(&key[16]);
+    keySchedule[12] = load32(&key[20]);
+    keySchedule[13] = load32(&key[24]);
+    keySchedule[14] = load32(&key[28]);
+    keySchedule[15] = load32(&constants[12]);
+}
+
+void Salsa20Engine::process(const uint8_t iv[IV_SIZE], uint8_t* data, size_t numBytes, uint64_t firstBlock) const {
+    uint32_t input[16];
+    memcpy(input, keySchedule, sizeof(input));
+    input[6] = load32(&iv[0]);
+    input[7] = load32(&iv[4]);
+
+    uint64_t counter = firstBlock;
+    // The lane pass pays off as soon as its last block is at least partly used
+    if (LANES > 1) {
+        while (numBytes > (LANES - 1) * BLOCK_SIZE) {
+            size_t passBytes = numBytes < LANES * BLOCK_SIZE ? numBytes : LANES * BLOCK_SIZE;
+            processLanes(input, counter, data, passBytes);
+            counter += LANES;
+            data += passBytes;
+            numBytes -= passBytes;
+        }
+    }
+    while (numBytes > 0) {
+        size_t blockBytes = numBytes < BLOCK_SIZE ? numBytes : BLOCK_SIZE;
+        processBlock(input, counter++, data, blockBytes);
+        data += blockBytes;
+        numBytes -= blockBytes;
+    }
+}
+
+IRAM_ATTR void Salsa20Engine::processBlock(const uint32_t input[16], uint64_t counter, uint8_t* data, size_t numBytes) const {
+    uint32_t in[16];
+    memcpy(in, input, sizeof(in));
+    in[8] = static_cast<uint32_t>(counter);
+    in[9] = static_cast<uint32_t>(counter >> 32);
+
+    uint32_t x[16];
+    memcpy(x, in, sizeof(x));
+    doubleRounds(x);
+
+    size_t numWords = numBytes / 4;
+    for (size_t i = 0; i < numWords; ++i) {
+        store32(&data[i * 4], load32(&data[i * 4]) ^ (x[i] + in[i]));
+    }
+    // Partial tail word of the last block
+    if (numWords < 16) {
+        uint32_t word = x[numWords] + in[numWords];
+        for (size_t b = numWords * 4; b < numBytes; ++b, word >>= 8) {
+            data[b] ^= static_cast<uint8_t>(word);
+        }
+    }
+}
+
+#if defined(__GNUC__) && !defined(__XTENSA__)
+
+typedef uint32_t u32x4 __attribute__((vector_size(16)));
+
+void Salsa20Engine::processLanes(const uint32_t input[16], uint64_t counter, uint8_t* data, size_t numBytes) const {
+    static_assert(LANES == 4, "lane code is written for four interleaved blocks");
+    u32x4 in[16];
+    for (int i = 0; i < 16; ++i) {
+        in[i] = u32x4{ input[i], input[i], input[i], input[i] };
+    }
+    uint64_t c0 = counter, c1 = counter + 1, c2 = counter + 2, c3 = counter + 3;
+    in[8] = u32x4{ static_cast<uint32_t>(c0), static_cast<uint32_t>(c1), static_cast<uint32_t>(c2), static_cast<uint32_t>(c3) };
+    in[9] = u32x4{ static_cast<uint32_t>(c0 >> 32), static_cast<uint32_t>(c1 >> 32), static_cast<uint32_t>(c2 >> 32), static_cast<uint32_t>(c3 >> 32) };
+
+    u32x4 x[16];
+    memcpy(x, in, sizeof(x));
+    doubleRounds(x);
+
+    for (int i = 0; i < 16; ++i) {
+        x[i] += in[i];
+    }
+    for (size_t lane = 0; lane < LANES && lane * BLOCK_SIZE < numBytes; ++lane) {
+        uint8_t* block = &data[lane * BLOCK_SIZE];
+        size_t blockBytes = numBytes - lane * BLOCK_SIZE;
+        size_t numWords = blockBytes < BLOCK_SIZE ? blockBytes / 4 : 16;
+        for (size_t i = 0; i < numWords; ++i) {
+            store32(&block[i * 4], load32(&block[i * 4]) ^ x[i][lane]);
+        }
+        if (numWords < 16) {
+            uint32_t word = x[numWords][lane];
+            for (size_t b = numWords * 4; b < blockBytes; ++b, word >>= 8) {
+                block[b] ^= static_cast<uint8_t>(word);
+            }
+        }
+    }
+}
+
+#else
+
+void Salsa20Engine::processLanes(const uint32_t input[16], uint64_t counter, uint8_t* data, size_t numBytes) const {
+    processBlock(input, counter, data, numBytes);
+}
+
+#endif
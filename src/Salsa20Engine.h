@@ -0,0 +1,37 @@
+#ifndef SALSA20ENGINE_H
+#define SALSA20ENGINE_H
+
+#include <inttypes.h>
+#include <stddef.h>
+
+// Keystream engine for the GT7 decrypt path, bit-exact with ucstk::Salsa20.
+//
+// The key words are expanded once in setKey(); each process() call only fills
+// in the IV and counter. On the host several counter blocks are computed in
+// one interleaved pass with GCC vector extensions (SSE2/NEON), on the Xtensa
+// a single block at a time keeps the state in registers. The keystream is
+// XORed into the buffer a word at a time.
+class Salsa20Engine {
+    public:
+        static constexpr size_t BLOCK_SIZE = 64;
+        static constexpr size_t KEY_SIZE = 32;
+        static constexpr size_t IV_SIZE = 8;
+#if defined(__GNUC__) && !defined(__XTENSA__)
+        static constexpr size_t LANES = 4;
+#else
+        static constexpr size_t LANES = 1;
+#endif
+
+        void setKey(const uint8_t key[KEY_SIZE]);
+        // En-/decrypts numBytes in place with the keystream starting at
+        // firstBlock, so a buffer can be processed in several steps
+        void process(const uint8_t iv[IV_SIZE], uint8_t* data, size_t numBytes, uint64_t firstBlock = 0) const;
+
+    private:
+        void processBlock(const uint32_t input[16], uint64_t counter, uint8_t* data, size_t numBytes) const;
+        void processLanes(const uint32_t input[16], uint64_t counter, uint8_t* data, size_t numBytes) const;
+
+        uint32_t keySchedule[16] = {};
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+// Single-writer/multi-reader snapshot. The writer never waits; a reader
+// copies the value and retries if a publish() overlapped, giving up after a
+// bounded number of attempts so it can never be starved (it then keeps the
+// copy it already had). The payload lives in relaxed atomic words, which keeps
+// the concurrent copy free of data races.
+template <typename T>
+class SeqlockSnapshot {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshot payload must be trivially copyable");
+    public:
+        static constexpr int MAX_READ_ATTEMPTS = 4;
+
+        void publish(const T& value) {
+            uint32_t words[WORDS] = {};
+            memcpy(words, &value, sizeof(T));
+            uint32_t s = sequence.load(std::memory_order_relaxed);
+            sequence.store(s + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = 0; i < WORDS; ++i) {
+                data[i].store(words[i], std::memory_order_relaxed);
+            }
+            sequence.store(s + 2, std::memory_order_release);
+        }
+
+        // Returns false, leaving value untouched, if nothing consistent could
+        // be read within MAX_READ_ATTEMPTS or nothing was published yet
+        bool read(T& value) const {
+            for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt) {
+                uint32_t before = sequence.load(std::memory_order_acquire);
+                if (before == 0) {
+                    return false;
+                }
+                if ((before & 1) != 0) {
+                    continue;
+                }
+                uint32_t words[WORDS];
+                for (size_t i = 0; i < WORDS; ++i) {
+                    words[i] = data[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before) {
+                    memcpy(&value, words, sizeof(T));
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Number of publish() calls so far, cheap change detection for readers
+        uint32_t version() const {
+            return sequence.load(std::memory_order_acquire) / 2;
+        }
+
+    private:
+        static constexpr size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<uint32_t> data[WORDS] = {};
+};
+
+#endif
@@ -0,0 +1,288 @@
+#include "Settings.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Frequencies within what the shakers reproduce, FREQUENCY_DIVISOR above 0
+const Setting settings[] = {
+    { "BASE_FREQUENCY", SettingType::Int, offsetof(VibrationConfig, baseFrequency), 1, 200 },
+    { "FREQUENCY_PER_INTENSITY", SettingType::Int, offsetof(VibrationConfig, frequencyPerIntensity), 0, 100 },
+    { "GEAR_SHIFT_FREQUENCY", SettingType::Int, offsetof(VibrationConfig, gearShiftFrequency), 1, 200 },
+    { "NORMAL_FREQUENCY", SettingType::Int, offsetof(VibrationConfig, normalFrequency), 1, 200 },
+    { "GEAR_SHIFT_DURATION", SettingType::Int, offsetof(VibrationConfig, gearShiftDuration), 0, 2000 },
+    { "RPM_MAX", SettingType::Int, offsetof(VibrationConfig, rpmMax), 0, 20000 },
+    { "RPM_MIN", SettingType::Int, offsetof(VibrationConfig, rpmMin), 0, 20000 },
+    { "AMPLITUDE_FACTOR", SettingType::Float, offsetof(VibrationConfig, amplitudeFactor), 0, 1 },
+    { "FREQUENCY_DIVISOR", SettingType::Int, offsetof(VibrationConfig, frequencyDivisor), 1, 1000 },
+    { "TIRE_SLIP_FACTOR", SettingType::Float, offsetof(VibrationConfig, tireSlipFactor), 0, 1000 },
+    { "SUSPENSION_HEIGHT_FACTOR", SettingType::Float, offsetof(VibrationConfig, suspensionHeightFactor), 0, 1000 },
+    { "useTireSlip", SettingType::Bool, offsetof(VibrationConfig, useTireSlip), 0, 1 },
+    { "useRPM", SettingType::Bool, offsetof(VibrationConfig, useRPM), 0, 1 },
+    { "useSuspHeight", SettingType::Bool, offsetof(VibrationConfig, useSuspHeight), 0, 1 },
+    { "tireSlipIntensity", SettingType::Int, offsetof(VibrationConfig, tireSlipIntensity), 0, 100 },
+    { "rpmIntensity", SettingType::Int, offsetof(VibrationConfig, rpmIntensity), 0, 100 },
+    { "suspHeightIntensity", SettingType::Int, offsetof(VibrationConfig, suspHeightIntensity), 0, 100 },
+};
+
+const size_t settingCount = sizeof(settings) / sizeof(settings[0]);
+
+// -1 (NO_INTENSITY_OVERRIDE) falls back to the global intensity
+const Setting carSettings[] = {
+    { "rpmIntensity", SettingType::Int8, offsetof(CarProfile, rpmIntensity), -1, 100 },
+    { "tireSlipIntensity", SettingType::Int8, offsetof(CarProfile, tireSlipIntensity), -1, 100 },
+    { "suspHeightIntensity", SettingType::Int8, offsetof(CarProfile, suspHeightIntensity), -1, 100 },
+};
+
+const size_t carSettingCount = sizeof(carSettings) / sizeof(carSettings[0]);
+
+// Longest number we accept, anything longer is not a sensible setting
+static const size_t MAX_VALUE_LENGTH = 24;
+
+const char* settingResultName(SettingResult result) {
+    switch (result) {
+        case SettingResult::Ok: return "ok";
+        case SettingResult::UnknownName: return "unknown setting";
+        case SettingResult::InvalidValue: return "invalid value";
+        case SettingResult::OutOfRange: return "out of range";
+        case SettingResult::Malformed: return "malformed request";
+    }
+    return "";
+}
+
+static const Setting* findIn(const Setting* table, size_t count, const char* name, size_t nameLength) {
+    for (size_t i = 0; i < count; ++i) {
+        if (strlen(table[i].name) == nameLength && strncmp(table[i].name, name, nameLength) == 0) {
+            return &table[i];
+        }
+    }
+    return nullptr;
+}
+
+const Setting* findSetting(const char* name, size_t nameLength) {
+    return findIn(settings, settingCount, name, nameLength);
+}
+
+static SettingResult parseValue(const Setting& setting, const char* value, size_t valueLength, double& parsed) {
+    if (valueLength == 0 || valueLength > MAX_VALUE_LENGTH) {
+        return SettingResult::InvalidValue;
+    }
+    char text[MAX_VALUE_LENGTH + 1];
+    memcpy(text, value, valueLength);
+    text[valueLength] = '\0';
+    if (setting.type == SettingType::Bool && (strcmp(text, "true") == 0 || strcmp(text, "false") == 0)) {
+        parsed = text[0] == 't' ? 1 : 0;
+        return SettingResult::Ok;
+    }
+    char* end;
+    parsed = strtod(text, &end);
+    if (end != text + valueLength) {
+        return SettingResult::InvalidValue;
+    }
+    if (setting.type != SettingType::Float && parsed != floor(parsed)) {
+        return SettingResult::InvalidValue;
+    }
+    // Written so that NaN fails as well
+    if (!(parsed >= setting.min && parsed <= setting.max)) {
+        return SettingResult::OutOfRange;
+    }
+    return SettingResult::Ok;
+}
+
+static void* field(void* target, const Setting& setting) {
+    return static_cast<uint8_t*>(target) + setting.offset;
+}
+
+static const void* field(const void* target, const Setting& setting) {
+    return static_cast<const uint8_t*>(target) + setting.offset;
+}
+
+static void storeValue(void* target, const Setting& setting, double value) {
+    switch (setting.type) {
+        case SettingType::Int: *static_cast<int32_t*>(field(target, setting)) = static_cast<int32_t>(value); break;
+        case SettingType::Int8: *static_cast<int8_t*>(field(target, setting)) = static_cast<int8_t>(value); break;
+        case SettingType::Float: *static_cast<float*>(field(target, setting)) = static_cast<float>(value); break;
+        case SettingType::Bool: *static_cast<bool*>(field(target, setting)) = value != 0; break;
+    }
+}
+
+SettingResult applySetting(VibrationConfig& config, const char* name, size_t nameLength, const char* value, size_t valueLength) {
+    const Setting* setting = findSetting(name, nameLength);
+    if (setting == nullptr) {
+        return SettingResult::UnknownName;
+    }
+    double parsed;
+    SettingResult result = parseValue(*setting, value, valueLength, parsed);
+    if (result == SettingResult::Ok) {
+        storeValue(&config, *setting, parsed);
+    }
+    return result;
+}
+
+SettingResult applySettingAssignment(VibrationConfig& config, const char* assignment) {
+    const char* equals = strchr(assignment, '=');
+    if (equals == nullptr) {
+        return SettingResult::Malformed;
+    }
+    return applySetting(config, assignment, static_cast<size_t>(equals - assignment), equals + 1, strlen(equals + 1));
+}
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Walks the object once; with apply false it only validates
+static SettingResult walkSettingsJson(const Setting* table, size_t count, void* target, const char* json, size_t length, bool apply) {
+    const char* p = json;
+    const char* end = json + length;
+    auto skipSpace = [&] {
+        while (p < end && isSpace(*p)) {
+            ++p;
+        }
+    };
+
+    skipSpace();
+    if (p == end || *p++ != '{') {
+        return SettingResult::Malformed;
+    }
+    skipSpace();
+    if (p < end && *p == '}') {
+        ++p;
+    } else {
+        for (;;) {
+            // Setting names never need escapes
+            if (p == end || *p++ != '"') {
+                return SettingResult::Malformed;
+            }
+            const char* name = p;
+            while (p < end && *p != '"' && *p != '\\') {
+                ++p;
+            }
+            if (p == end || *p != '"') {
+                return SettingResult::Malformed;
+            }
+            size_t nameLength = static_cast<size_t>(p - name);
+            ++p;
+            skipSpace();
+            if (p == end || *p++ != ':') {
+                return SettingResult::Malformed;
+            }
+            skipSpace();
+            const char* value = p;
+            while (p < end && *p != ',' && *p != '}' && !isSpace(*p)) {
+                ++p;
+            }
+            size_t valueLength = static_cast<size_t>(p - value);
+
+            const Setting* setting = findIn(table, count, name, nameLength);
+            if (setting == nullptr) {
+                return SettingResult::UnknownName;
+            }
+            double parsed;
+            SettingResult result = parseValue(*setting, value, valueLength, parsed);
+            if (result != SettingResult::Ok) {
+                return result;
+            }
+            if (apply) {
+                storeValue(target, *setting, parsed);
+            }
+
+            skipSpace();
+            if (p == end) {
+                return SettingResult::Malformed;
+            }
+            char separator = *p++;
+            if (separator == '}') {
+                break;
+            }
+            if (separator != ',') {
+                return SettingResult::Malformed;
+            }
+            skipSpace();
+        }
+    }
+    skipSpace();
+    return p == end ? SettingResult::Ok : SettingResult::Malformed;
+}
+
+static SettingResult applyJson(const Setting* table, size_t count, void* target, const char* json, size_t length) {
+    SettingResult result = walkSettingsJson(table, count, target, json, length, false);
+    if (result != SettingResult::Ok) {
+        return result;
+    }
+    return walkSettingsJson(table, count, target, json, length, true);
+}
+
+SettingResult applySettingsJson(VibrationConfig& config, const char* json, size_t length) {
+    return applyJson(settings, settingCount, &config, json, length);
+}
+
+SettingResult applyCarSettingsJson(CarProfile& profile, const char* json, size_t length) {
+    return applyJson(carSettings, carSettingCount, &profile, json, length);
+}
+
+// Members of one table, without the braces; returns the length or 0 if the
+// buffer is too small
+static size_t formatMembers(const Setting* table, size_t count, const void* target, char* buffer, size_t size) {
+    size_t used = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const Setting& setting = table[i];
+        const char* separator = i + 1 < count ? "," : "";
+        int written = 0;
+        switch (setting.type) {
+            case SettingType::Int:
+                written = snprintf(buffer + used, size - used, "\"%s\":%d%s", setting.name, static_cast<int>(*static_cast<const int32_t*>(field(target, setting))), separator);
+                break;
+            case SettingType::Int8:
+                written = snprintf(buffer + used, size - used, "\"%s\":%d%s", setting.name, static_cast<int>(*static_cast<const int8_t*>(field(target, setting))), separator);
+                break;
+            case SettingType::Float:
+                written = snprintf(buffer + used, size - used, "\"%s\":%g%s", setting.name, *static_cast<const float*>(field(target, setting)), separator);
+                break;
+            case SettingType::Bool:
+                written = snprintf(buffer + used, size - used, "\"%s\":%s%s", setting.name, *static_cast<const bool*>(field(target, setting)) ? "true" : "false", separator);
+                break;
+        }
+        if (written < 0 || used + static_cast<size_t>(written) >= size) {
+            return 0;
+        }
+        used += static_cast<size_t>(written);
+    }
+    return used;
+}
+
+size_t formatSettingsJson(const VibrationConfig& config, char* buffer, size_t size) {
+    if (size < 3) {
+        return 0;
+    }
+    buffer[0] = '{';
+    size_t used = formatMembers(settings, settingCount, &config, buffer + 1, size - 2);
+    if (used == 0) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    buffer[used + 1] = '}';
+    buffer[used + 2] = '\0';
+    return used + 2;
+}
+
+size_t formatCarProfileJson(const CarProfile& profile, char* buffer, size_t size) {
+    int written = snprintf(buffer, size, "{\"carCode\":%ld,\"idleRPM\":%g,\"redlineRPM\":%g,", static_cast<long>(profile.carCode), profile.idleRPM, profile.redlineRPM);
+    if (written < 0 || static_cast<size_t>(written) + 2 >= size) {
+        if (size > 0) {
+            buffer[0] = '\0';
+        }
+        return 0;
+    }
+    size_t used = static_cast<size_t>(written);
+    size_t members = formatMembers(carSettings, carSettingCount, &profile, buffer + used, size - used - 1);
+    if (members == 0) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    used += members;
+    buffer[used++] = '}';
+    buffer[used] = '\0';
+    return used;
+}
@@ -0,0 +1,51 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stddef.h>
+#include "TelemetryFrame.h"
+#include "VibrationConfig.h"
+
+// The fields of VibrationConfig by their config.h names, for the web UI, the
+// JSON API and the renderer's -P. Everything works on caller buffers and a
+// caller's copy of the config, nothing allocates, so the web task can answer
+// requests without touching the heap.
+
+enum class SettingType { Int, Int8, Float, Bool };
+
+struct Setting {
+    const char* name;  // as in config.h, also the JSON key
+    SettingType type;
+    size_t offset;     // of the field in VibrationConfig (CarProfile for carSettings)
+    float min;         // values outside are rejected
+    float max;
+};
+
+extern const Setting settings[];
+extern const size_t settingCount;
+// The per-car intensity overrides of a CarProfile
+extern const Setting carSettings[];
+extern const size_t carSettingCount;
+
+enum class SettingResult { Ok, UnknownName, InvalidValue, OutOfRange, Malformed };
+
+const char* settingResultName(SettingResult result);
+
+const Setting* findSetting(const char* name, size_t nameLength);
+// value is a number, for Bool also true/false
+SettingResult applySetting(VibrationConfig& config, const char* name, size_t nameLength, const char* value, size_t valueLength);
+// "name=value"
+SettingResult applySettingAssignment(VibrationConfig& config, const char* assignment);
+
+// Flat JSON object {"name": value, ...}. All members are checked before the
+// first one is applied, a bad request changes nothing.
+SettingResult applySettingsJson(VibrationConfig& config, const char* json, size_t length);
+// Writes all settings as a JSON object, returns the length (0 if the
+// buffer is too small)
+size_t formatSettingsJson(const VibrationConfig& config, char* buffer, size_t size);
+
+// Same for the overrides of one car, e.g. {"rpmIntensity":-1}
+SettingResult applyCarSettingsJson(CarProfile& profile, const char* json, size_t length);
+// The learned rpm range and the overrides
+size_t formatCarProfileJson(const CarProfile& profile, char* buffer, size_t size);
+
+#endif
@@ -0,0 +1,74 @@
+#include "SocketPacketSource.h"
+#include <string.h>
+#include <unistd.h>
+#ifdef ARDUINO
+#include <lwip/sockets.h>
+#include <lwip/inet.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+SocketPacketSource::SocketPacketSource(uint8_t ip1, uint8_t ip2, uint8_t ip3, uint8_t ip4) {
+    remoteAddr = htonl((static_cast<uint32_t>(ip1) << 24) | (static_cast<uint32_t>(ip2) << 16) |
+                       (static_cast<uint32_t>(ip3) << 8) | ip4);
+}
+
+SocketPacketSource::SocketPacketSource(const char* remoteHost) {
+    in_addr addr;
+    if (inet_pton(AF_INET, remoteHost, &addr) == 1) {
+        remoteAddr = addr.s_addr;
+    }
+}
+
+SocketPacketSource::~SocketPacketSource() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+bool SocketPacketSource::begin(uint16_t localPort) {
+    fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (fd < 0) {
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(localPort);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+}
+
+int SocketPacketSource::receive(uint8_t* buffer, size_t capacity) {
+    if (fd < 0) {
+        return 0;
+    }
+    iovec iov = { buffer, capacity };
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    int length = recvmsg(fd, &msg, MSG_DONTWAIT);
+    if (length <= 0) {
+        return 0;
+    }
+    return (msg.msg_flags & MSG_TRUNC) ? static_cast<int>(capacity) + 1 : length;
+}
+
+void SocketPacketSource::send(uint16_t remotePort, const uint8_t* data, size_t length) {
+    if (fd < 0) {
+        return;
+    }
+    sockaddr_in remote = {};
+    remote.sin_family = AF_INET;
+    remote.sin_addr.s_addr = remoteAddr;
+    remote.sin_port = htons(remotePort);
+    sendto(fd, data, length, 0, reinterpret_cast<sockaddr*>(&remote), sizeof(remote));
+}
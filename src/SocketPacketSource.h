@@ -0,0 +1,23 @@
+#ifndef SOCKETPACKETSOURCE_H
+#define SOCKETPACKETSOURCE_H
+
+#include "Platform.h"
+
+// Non-blocking BSD socket, lwIP on the ESP32 and POSIX on the host. Unlike
+// WiFiUDP it copies each datagram exactly once, straight into the caller's
+// buffer, without a heap allocation per packet.
+class SocketPacketSource : public PacketSource {
+    public:
+        SocketPacketSource(uint8_t ip1, uint8_t ip2, uint8_t ip3, uint8_t ip4);
+        explicit SocketPacketSource(const char* remoteHost);
+        ~SocketPacketSource() override;
+        bool begin(uint16_t localPort) override;
+        // Truncated datagrams are reported with a length of capacity + 1
+        int receive(uint8_t* buffer, size_t capacity) override;
+        void send(uint16_t remotePort, const uint8_t* data, size_t length) override;
+    private:
+        int fd = -1;
+        uint32_t remoteAddr = 0; // network byte order
+};
+
+#endif
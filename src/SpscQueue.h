@@ -0,0 +1,43 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+
+// Bounded lock-free queue for exactly one producer and one consumer task.
+// Neither side ever blocks: push() fails when full, pop() when empty.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    public:
+        bool push(const T& item) {
+            size_t h = head.load(std::memory_order_relaxed);
+            if (h - tail.load(std::memory_order_acquire) == Capacity) {
+                return false;
+            }
+            items[h & (Capacity - 1)] = item;
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool pop(T& item) {
+            size_t t = tail.load(std::memory_order_relaxed);
+            if (t == head.load(std::memory_order_acquire)) {
+                return false;
+            }
+            item = items[t & (Capacity - 1)];
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        size_t size() const {
+            return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::atomic<size_t> head{0};
+        std::atomic<size_t> tail{0};
+        T items[Capacity];
+};
+
+#endif
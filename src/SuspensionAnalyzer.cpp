@@ -0,0 +1,77 @@
+#include "SuspensionAnalyzer.h"
+#include "GT7UDPParser.h"
+#include <math.h>
+
+// Longer gaps (lost packets, pause, new session) restart the filters
+// instead of feeding them one huge step
+static const int32_t MAX_PACKET_GAP = 6;
+
+void SuspensionAnalyzer::configure(const SuspensionFilterConfig& config) {
+    this->config = config;
+    bodyFilter.clearSections();
+    bodyFilter.addSection(biquadHighPass(config.highPassHz, 0.7071f, gt7PacketRate));
+    textureFilter.clearSections();
+    textureFilter.addSection(biquadBandPass(config.textureHz, config.textureQ, gt7PacketRate));
+    releasePerPacket = config.releaseMs > 0 ? expf(-1000.0f / (config.releaseMs * gt7PacketRate)) : 0;
+    started = false;
+}
+
+void SuspensionAnalyzer::restart(TelemetryFrame& frame) {
+    bodyFilter.reset();
+    textureFilter.reset();
+    for (int i = 0; i < 4; ++i) {
+        lastVelocity[i] = 0;
+        envelope[i] = 0;
+        frame.suspVelocity[i] = 0;
+        frame.suspAcceleration[i] = 0;
+        frame.roadTexture[i] = 0;
+    }
+}
+
+void SuspensionAnalyzer::process(const TelemetryHistory& history, TelemetryFrame& frame) {
+    int32_t step = static_cast<int32_t>(static_cast<uint32_t>(frame.packetId) - static_cast<uint32_t>(lastPacketId));
+    bool restarting = !started || step <= 0 || step > MAX_PACKET_GAP || history.size() < 2;
+    started = true;
+    lastPacketId = frame.packetId;
+    if (restarting) {
+        restart(frame);
+        return;
+    }
+
+    // GT7 samples at a fixed rate, the packetId is a better clock than the
+    // receive time, which carries the WiFi jitter
+    float dt = step / gt7PacketRate;
+    int32_t measured[BiquadBank::LANES] = {};
+    for (uint8_t i = 0; i < 4; ++i) {
+        float v = history.delta(wheelChannel(HistoryChannel::SuspHeight, i), 2) / dt;
+        measured[i] = static_cast<int32_t>(lrintf(v * BiquadBank::ONE));
+    }
+
+    // The filters are designed for one sample per packet. Packets skipped by
+    // latest-wins ingest are filled with the mean velocity across the gap,
+    // so cutoff and centre stay where they were designed.
+    int32_t velocity[BiquadBank::LANES];
+    int32_t texture[BiquadBank::LANES];
+    for (int32_t n = 0; n < step; ++n) {
+        for (int i = 0; i < 4; ++i) {
+            velocity[i] = measured[i];
+        }
+        bodyFilter.process(velocity);
+        for (int i = 0; i < 4; ++i) {
+            texture[i] = velocity[i];
+        }
+        textureFilter.process(texture);
+        for (int i = 0; i < 4; ++i) {
+            float level = fabsf(static_cast<float>(texture[i]) / BiquadBank::ONE);
+            envelope[i] = level > envelope[i] * releasePerPacket ? level : envelope[i] * releasePerPacket;
+        }
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        float v = static_cast<float>(velocity[i]) / BiquadBank::ONE;
+        frame.suspVelocity[i] = v;
+        frame.suspAcceleration[i] = (v - lastVelocity[i]) / dt;
+        lastVelocity[i] = v;
+        frame.roadTexture[i] = envelope[i];
+    }
+}
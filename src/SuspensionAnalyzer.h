@@ -0,0 +1,41 @@
+#ifndef SUSPENSIONANALYZER_H
+#define SUSPENSIONANALYZER_H
+
+#include <inttypes.h>
+#include "BiquadBank.h"
+#include "TelemetryFrame.h"
+#include "TelemetryHistory.h"
+
+struct SuspensionFilterConfig {
+    float highPassHz = 1.5f;  // below: body pitch, roll and dive, not road input
+    float textureHz = 8;      // centre of the road texture band
+    float textureQ = 0.7f;
+    uint16_t releaseMs = 150; // decay of the texture envelope
+};
+
+// Per-corner suspension velocity and acceleration instead of the static
+// ride height. Runs in the ingest task on every accepted packet: velocity is
+// the height difference to the previous packet, high-passed to drop body
+// motion, and a band-pass on top gives the road texture, whose envelope
+// drives the suspension voice.
+class SuspensionAnalyzer {
+    public:
+        void configure(const SuspensionFilterConfig& config);
+        // Fills the suspension channels of frame, which must be the newest
+        // frame pushed into history
+        void process(const TelemetryHistory& history, TelemetryFrame& frame);
+
+    private:
+        void restart(TelemetryFrame& frame);
+
+        SuspensionFilterConfig config;
+        BiquadBank bodyFilter;
+        BiquadBank textureFilter;
+        float releasePerPacket = 0;
+        bool started = false;
+        int32_t lastPacketId = 0;
+        float lastVelocity[4] = {};
+        float envelope[4] = {};
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef TELEMETRYFRAME_H
+#define TELEMETRYFRAME_H
+
+#include <inttypes.h>
+#include <stddef.h>
+
+// Road texture bands, see RoadTextureDetector
+constexpr size_t TEXTURE_BANDS = 3;
+
+// Tuning of one car, learned and stored per carCode, see CarProfileStore.
+// Travels with every frame, so a car change reaches the audio task together
+// with the first packet of the new car.
+struct CarProfile {
+    int32_t carCode;
+    float idleRPM;             // lowest rpm seen with the engine running, 0 for electric cars
+    float redlineRPM;          // maxAlertRPM, the highest rpm seen if the car reports none
+    int8_t rpmIntensity;       // % overrides of the global settings, NO_INTENSITY_OVERRIDE for none
+    int8_t tireSlipIntensity;
+    int8_t suspHeightIntensity;
+    uint8_t powertrainType;
+};
+
+constexpr int8_t NO_INTENSITY_OVERRIDE = -1;
+
+// Decoded telemetry state handed from the ingest task to the audio task,
+// see GT7_UDP_Parser::decodeFrame()
+struct TelemetryFrame {
+    uint32_t receivedMicros;   // clockMicros() when the datagram was received
+    int32_t packetId;
+    int32_t carCode;
+    float speed;               // km/h
+    float rpm;
+    float tyreSlipRatio[4];    // tyre speed / car speed (FL, FR, RL, RR)
+    float suspHeight[4];
+    float wheelRPS[4];
+    float suspVelocity[4];     // m/s, body motion removed, see SuspensionAnalyzer
+    float suspAcceleration[4]; // m/s^2
+    float roadTexture[4];      // m/s, envelope of the road texture band
+    float textureBands[TEXTURE_BANDS]; // m, amplitude of periodic road excitation per band
+    float roadPlaneDistance;
+    float wheelRotation;       // rad, this and the accelerations are 0 for the 'A' layout
+    float sway;                // m/s^2
+    float heave;
+    float surge;
+    int16_t minAlertRPM;
+    int16_t maxAlertRPM;
+    uint16_t flags;            // SimulatorFlags
+    uint8_t currentGear;
+    uint8_t suggestedGear;
+    uint8_t throttle;
+    uint8_t brake;
+    uint8_t powertrainType;
+    CarProfile car;            // filled in during ingest, not by the parser
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "TelemetryHistory.h"
+#include <math.h>
+
+// Four independent partial sums, so the loop is not serialised on one
+// floating point add and the compiler can keep them in vector lanes
+static float sum(const float* x, size_t n) {
+    float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += x[i];
+        s1 += x[i + 1];
+        s2 += x[i + 2];
+        s3 += x[i + 3];
+    }
+    for (; i < n; ++i) {
+        s0 += x[i];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+static float sumSquares(const float* x, size_t n, float offset) {
+    float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float d0 = x[i] - offset, d1 = x[i + 1] - offset, d2 = x[i + 2] - offset, d3 = x[i + 3] - offset;
+        s0 += d0 * d0;
+        s1 += d1 * d1;
+        s2 += d2 * d2;
+        s3 += d3 * d3;
+    }
+    for (; i < n; ++i) {
+        float d = x[i] - offset;
+        s0 += d * d;
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+void TelemetryHistory::store(HistoryChannel channel, float value) {
+    float* column = columns[static_cast<size_t>(channel)];
+    column[next] = value;
+    column[next + CAPACITY] = value;
+}
+
+void TelemetryHistory::push(const TelemetryFrame& frame) {
+    store(HistoryChannel::Speed, frame.speed);
+    store(HistoryChannel::Rpm, frame.rpm);
+    store(HistoryChannel::Throttle, frame.throttle);
+    store(HistoryChannel::Brake, frame.brake);
+    store(HistoryChannel::RoadPlaneDistance, frame.roadPlaneDistance);
+    store(HistoryChannel::WheelRotation, frame.wheelRotation);
+    store(HistoryChannel::Sway, frame.sway);
+    store(HistoryChannel::Heave, frame.heave);
+    store(HistoryChannel::Surge, frame.surge);
+    for (uint8_t i = 0; i < 4; ++i) {
+        store(wheelChannel(HistoryChannel::SuspHeight, i), frame.suspHeight[i]);
+        store(wheelChannel(HistoryChannel::WheelRPS, i), frame.wheelRPS[i]);
+        store(wheelChannel(HistoryChannel::TyreSlipRatio, i), frame.tyreSlipRatio[i]);
+    }
+    micros[next] = frame.receivedMicros;
+    micros[next + CAPACITY] = frame.receivedMicros;
+    next = (next + 1) % CAPACITY;
+    count = count < CAPACITY ? count + 1 : CAPACITY;
+}
+
+void TelemetryHistory::clear() {
+    next = 0;
+    count = 0;
+}
+
+const float* TelemetryHistory::window(HistoryChannel channel, size_t n) const {
+    return columns[static_cast<size_t>(channel)] + start(clamp(n));
+}
+
+const uint32_t* TelemetryHistory::times(size_t n) const {
+    return micros + start(clamp(n));
+}
+
+float TelemetryHistory::mean(HistoryChannel channel, size_t n) const {
+    n = clamp(n);
+    return n > 0 ? sum(window(channel, n), n) / n : 0;
+}
+
+float TelemetryHistory::variance(HistoryChannel channel, size_t n) const {
+    n = clamp(n);
+    // Two passes, the deviations stay small compared to e.g. the rpm itself
+    return n > 0 ? sumSquares(window(channel, n), n, mean(channel, n)) / n : 0;
+}
+
+float TelemetryHistory::rms(HistoryChannel channel, size_t n) const {
+    n = clamp(n);
+    return n > 0 ? sqrtf(sumSquares(window(channel, n), n, 0) / n) : 0;
+}
+
+float TelemetryHistory::delta(HistoryChannel channel, size_t n) const {
+    n = clamp(n);
+    if (n < 2) {
+        return 0;
+    }
+    const float* x = window(channel, n);
+    return x[n - 1] - x[0];
+}
+
+float TelemetryHistory::rate(HistoryChannel channel, size_t n) const {
+    n = clamp(n);
+    if (n < 2) {
+        return 0;
+    }
+    const uint32_t* t = times(n);
+    uint32_t span = t[n - 1] - t[0];
+    return span > 0 ? delta(channel, n) * 1e6f / span : 0;
+}
@@ -0,0 +1,70 @@
+#ifndef TELEMETRYHISTORY_H
+#define TELEMETRYHISTORY_H
+
+#include <inttypes.h>
+#include <stddef.h>
+#include "TelemetryFrame.h"
+
+// Channels kept in the history, per-wheel ones in FL, FR, RL, RR order
+enum class HistoryChannel : uint8_t {
+    Speed,
+    Rpm,
+    Throttle,
+    Brake,
+    RoadPlaneDistance,
+    WheelRotation,
+    Sway,
+    Heave,
+    Surge,
+    SuspHeight,
+    WheelRPS = SuspHeight + 4,
+    TyreSlipRatio = WheelRPS + 4,
+    Count = TyreSlipRatio + 4
+};
+
+// Channel of one wheel, e.g. wheelChannel(HistoryChannel::SuspHeight, 2) for RL
+constexpr HistoryChannel wheelChannel(HistoryChannel first, uint8_t wheel) {
+    return static_cast<HistoryChannel>(static_cast<uint8_t>(first) + wheel);
+}
+
+// Rolling window over the last CAPACITY accepted packets, one float column
+// per channel. Every sample is stored twice (at i and i + CAPACITY), so the
+// newest n samples of a channel are always one contiguous array, oldest
+// first, and window operations are plain loops over it. Fixed size
+// (sizeof(TelemetryHistory), about 11 KB), no allocation; filled by the
+// ingest task at packet rate and only used from that task.
+class TelemetryHistory {
+    public:
+        static constexpr size_t CAPACITY = 64; // ~1 s at 60 Hz
+
+        void push(const TelemetryFrame& frame);
+        void clear();
+        // Samples held, up to CAPACITY
+        size_t size() const { return count; }
+
+        // Newest n samples of a channel (n <= size()), oldest first
+        const float* window(HistoryChannel channel, size_t n) const;
+        // Receive times (clockMicros) of the same samples
+        const uint32_t* times(size_t n) const;
+
+        // Window operations over the newest n samples, n is capped at size()
+        float mean(HistoryChannel channel, size_t n) const;
+        float variance(HistoryChannel channel, size_t n) const;
+        float rms(HistoryChannel channel, size_t n) const;
+        // Newest minus oldest sample of the window
+        float delta(HistoryChannel channel, size_t n) const;
+        // delta() per second of receive time, 0 if the window spans no time
+        float rate(HistoryChannel channel, size_t n) const;
+
+    private:
+        size_t start(size_t n) const { return next + CAPACITY - n; }
+        size_t clamp(size_t n) const { return n < count ? n : count; }
+        void store(HistoryChannel channel, float value);
+
+        float columns[static_cast<size_t>(HistoryChannel::Count)][2 * CAPACITY] = {};
+        uint32_t micros[2 * CAPACITY] = {};
+        size_t next = 0;
+        size_t count = 0;
+};
+
+#endif
@@ -0,0 +1,168 @@
+#include "TelemetryPipeline.h"
+
+constexpr uint32_t HEARTBEAT_INTERVAL = 500;
+constexpr uint32_t PACKET_RATE_INTERVAL = 1000;
+
+void TelemetryPipeline::begin(GT7_UDP_Parser& parser, VibrationEngine& vibration, HapticMixer& mixer, AudioSink& out) {
+    this->parser = &parser;
+    this->vibration = &vibration;
+    this->mixer = &mixer;
+    this->out = &out;
+    haptics.begin(SAMPLE_RATE);
+    suspension.configure(SuspensionFilterConfig());
+    roadTexture.configure(RoadTextureConfig());
+}
+
+bool TelemetryPipeline::start() {
+    running = true;
+    return startTask("ingest", ingestTask, this, INGEST_STACK_SIZE, INGEST_PRIORITY, INGEST_CORE) &&
+           startTask("audio", audioTask, this, AUDIO_STACK_SIZE, AUDIO_PRIORITY, AUDIO_CORE);
+}
+
+void TelemetryPipeline::stop() {
+    running = false;
+}
+
+uint32_t TelemetryPipeline::getRenderedBlocks() const {
+    return renderedBlocks.load(std::memory_order_relaxed);
+}
+
+uint32_t TelemetryPipeline::getDroppedEvents() const {
+    return droppedEvents.load(std::memory_order_relaxed);
+}
+
+const SeqlockSnapshot<TelemetryFrame>& TelemetryPipeline::getTelemetry() const {
+    return telemetry;
+}
+
+ConfigStore& TelemetryPipeline::getConfig() {
+    return config;
+}
+
+CarProfileStore& TelemetryPipeline::getCarProfiles() {
+    return carProfiles;
+}
+
+size_t TelemetryPipeline::formatMetrics(char* buffer, size_t size) const {
+    if (size == 0) {
+        return 0;
+    }
+    buffer[0] = '\0';
+    const float cyclesPerMicro = static_cast<float>(clockCyclesPerMicro());
+    const IngestStats& stats = parser->getIngestStats();
+    size_t used = 0;
+    used = formatSummary(buffer, size, used, "gt7_ingest_us", ingestCycles, cyclesPerMicro);
+    used = formatSummary(buffer, size, used, "gt7_effects_us", effectsCycles, cyclesPerMicro);
+    used = formatSummary(buffer, size, used, "gt7_latency_us", latencyMicros, 1);
+    used = formatSummary(buffer, size, used, "gt7_block_interval_us", blockIntervalMicros, 1);
+    used = formatValue(buffer, size, used, "gt7_packet_rate", "gauge", packetRate.load(std::memory_order_relaxed));
+    used = formatValue(buffer, size, used, "gt7_packets_received_total", "counter", stats.received.load(std::memory_order_relaxed));
+    used = formatValue(buffer, size, used, "gt7_packets_accepted_total", "counter", stats.accepted.load(std::memory_order_relaxed));
+    used = formatValue(buffer, size, used, "gt7_packets_superseded_total", "counter", stats.superseded.load(std::memory_order_relaxed));
+    used = formatValue(buffer, size, used, "gt7_packets_rejected_short_total", "counter", stats.rejectedShort.load(std::memory_order_relaxed));
+    used = formatValue(buffer, size, used, "gt7_packets_rejected_long_total", "counter", stats.rejectedLong.load(std::memory_order_relaxed));
+    used = formatValue(buffer, size, used, "gt7_packets_rejected_magic_total", "counter", stats.rejectedMagic.load(std::memory_order_relaxed));
+    used = formatValue(buffer, size, used, "gt7_packets_rejected_packet_id_total", "counter", stats.rejectedPacketId.load(std::memory_order_relaxed));
+    used = formatValue(buffer, size, used, "gt7_audio_blocks_total", "counter", getRenderedBlocks());
+    used = formatValue(buffer, size, used, "gt7_audio_underruns_total", "counter", out->getUnderruns());
+    used = formatValue(buffer, size, used, "gt7_haptic_events_dropped_total", "counter", getDroppedEvents());
+    used = formatValue(buffer, size, used, "gt7_car_profile_loads_total", "counter", carProfiles.getLoads());
+    used = formatValue(buffer, size, used, "gt7_car_profile_save_failures_total", "counter", carProfiles.getSaveFailures());
+    size_t heap = freeHeap();
+    if (heap > 0) {
+        used = formatValue(buffer, size, used, "gt7_free_heap_bytes", "gauge", heap);
+    }
+    return used;
+}
+
+void TelemetryPipeline::ingestTask(void* arg) {
+    static_cast<TelemetryPipeline*>(arg)->runIngest();
+    endTask();
+}
+
+void TelemetryPipeline::audioTask(void* arg) {
+    static_cast<TelemetryPipeline*>(arg)->runAudio();
+    endTask();
+}
+
+bool TelemetryPipeline::ingest() {
+    uint32_t ingestStart = clockCycles();
+    if (!parser->readData()) {
+        return false;
+    }
+    ingestCycles.record(clockCycles() - ingestStart);
+    parser->decodeFrame(ingestFrame);
+    carProfiles.process(ingestFrame);
+    history.push(ingestFrame);
+    suspension.process(history, ingestFrame);
+    roadTexture.process(history, ingestFrame);
+    telemetry.publish(ingestFrame);
+    uint32_t dropped = eventDetector.process(ingestFrame, events);
+    if (dropped > 0) {
+        droppedEvents.fetch_add(dropped, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void TelemetryPipeline::renderBlock(uint32_t nowMs) {
+    uint32_t effectsStart = clockCycles();
+    // On a failed read the previous frame is simply used once more
+    hasAudioFrame |= telemetry.read(audioFrame);
+    const VibrationConfig& blockConfig = config.acquire(AUDIO_CONFIG_READER);
+    if (hasAudioFrame) {
+        vibration->processTelemetryData(audioFrame, nowMs, blockConfig);
+    }
+    HapticEventType event;
+    while (events.pop(event)) {
+        haptics.trigger(event, blockConfig);
+    }
+    // Bursts count towards the mixer's headroom, so the sum never clips
+    mixer->setOverlayLevel(haptics.peakLevel(AUDIO_BLOCK_FRAMES));
+    mixer->render(audioBlock, AUDIO_BLOCK_FRAMES, CHANNELS);
+    haptics.mix(audioBlock, AUDIO_BLOCK_FRAMES, CHANNELS, mixer->getOverlayGain());
+    effectsCycles.record(clockCycles() - effectsStart);
+
+    out->write(audioBlock, AUDIO_BLOCK_FRAMES);
+    uint32_t submitted = clockMicros();
+    if (hasAudioFrame && audioFrame.packetId != measuredPacketId) {
+        measuredPacketId = audioFrame.packetId;
+        latencyMicros.record(submitted - audioFrame.receivedMicros);
+    }
+    if (renderedBlocks.fetch_add(1, std::memory_order_relaxed) > 0) {
+        blockIntervalMicros.record(submitted - previousSubmit);
+    }
+    previousSubmit = submitted;
+}
+
+void TelemetryPipeline::runIngest() {
+    uint32_t previousT = clockMillis();
+    uint32_t rateT = previousT;
+    uint32_t rateAccepted = 0;
+    parser->sendHeartbeat();
+    while (running) {
+        bool received = ingest();
+
+        uint32_t currentT = clockMillis();
+        if (currentT - previousT >= HEARTBEAT_INTERVAL) {
+            previousT = currentT;
+            parser->sendHeartbeat();
+        }
+        if (currentT - rateT >= PACKET_RATE_INTERVAL) {
+            uint32_t accepted = parser->getIngestStats().accepted.load(std::memory_order_relaxed);
+            packetRate.store((accepted - rateAccepted) * 1000 / (currentT - rateT), std::memory_order_relaxed);
+            rateAccepted = accepted;
+            rateT = currentT;
+        }
+
+        if (!received) {
+            clockDelay(1);
+        }
+    }
+}
+
+void TelemetryPipeline::runAudio() {
+    // The sink blocks until there is room, which paces this task
+    while (running) {
+        renderBlock(clockMillis());
+    }
+}
@@ -0,0 +1,109 @@
+#ifndef TELEMETRYPIPELINE_H
+#define TELEMETRYPIPELINE_H
+
+#include <atomic>
+#include "Platform.h"
+#include "CarProfileStore.h"
+#include "GT7UDPParser.h"
+#include "HapticEvents.h"
+#include "HapticMixer.h"
+#include "Metrics.h"
+#include "Seqlock.h"
+#include "TelemetryFrame.h"
+#include "TelemetryHistory.h"
+#include "VibrationConfig.h"
+#include "SuspensionAnalyzer.h"
+#include "RoadTextureDetector.h"
+#include "VibrationEngine.h"
+
+// Task layout: network ingest (and the web UI of the firmware) share the
+// core running the WiFi stack, audio rendering gets the other core at high
+// priority. Ingest publishes each accepted packet as a TelemetryFrame
+// snapshot; the audio task picks up the latest one before every block and
+// runs the vibration engine on it, so neither side ever waits for the other.
+// Edges (gear shifts, flags) are detected per packet during ingest and handed
+// over through a lock-free queue to the haptic event scheduler. Every
+// accepted frame also goes into a rolling history for windowed analysis at
+// packet rate (suspension filters, road texture), which stays with the
+// ingest task.
+constexpr uint8_t INGEST_CORE = 0;
+constexpr uint8_t AUDIO_CORE = 1;
+constexpr uint8_t INGEST_PRIORITY = 5;
+constexpr uint8_t AUDIO_PRIORITY = 20;
+constexpr uint32_t INGEST_STACK_SIZE = 4096;
+constexpr uint32_t AUDIO_STACK_SIZE = 4096;
+// ConfigStore reader index of the audio task
+constexpr size_t AUDIO_CONFIG_READER = 0;
+
+constexpr uint32_t SAMPLE_RATE = 32000;
+constexpr uint8_t CHANNELS = 2;
+constexpr size_t AUDIO_BLOCK_FRAMES = 256;
+
+class TelemetryPipeline {
+    public:
+        void begin(GT7_UDP_Parser& parser, VibrationEngine& vibration, HapticMixer& mixer, AudioSink& out);
+        bool start();
+        // Lets both tasks return, only needed by the host build
+        void stop();
+        uint32_t getRenderedBlocks() const;
+        uint32_t getDroppedEvents() const;
+        // Latest decoded telemetry, readable from any task
+        const SeqlockSnapshot<TelemetryFrame>& getTelemetry() const;
+        // Tunables, starts with the defaults from config.cpp. Publish from
+        // one task only (the web UI), the audio task picks up the new
+        // snapshot with its next block.
+        ConfigStore& getConfig();
+        // Per-car rpm range and overrides, attached to every frame during
+        // ingest. Call begin() with the storage before start().
+        CarProfileStore& getCarProfiles();
+        // Stage timings and counters as Prometheus text, returns the length
+        size_t formatMetrics(char* buffer, size_t size) const;
+
+        // One step of each task. The tasks loop over these; offline tools
+        // call them directly from one thread with their own clock.
+        // Reads and publishes the next packet, false if none was accepted
+        bool ingest();
+        // Renders the next block for time nowMs and writes it to the sink
+        void renderBlock(uint32_t nowMs);
+
+    private:
+        static void ingestTask(void* arg);
+        static void audioTask(void* arg);
+        void runIngest();
+        void runAudio();
+
+        GT7_UDP_Parser* parser = nullptr;
+        VibrationEngine* vibration = nullptr;
+        HapticMixer* mixer = nullptr;
+        AudioSink* out = nullptr;
+        SeqlockSnapshot<TelemetryFrame> telemetry;
+        ConfigStore config;
+        CarProfileStore carProfiles;
+        TelemetryHistory history;
+        SuspensionAnalyzer suspension;
+        RoadTextureDetector roadTexture;
+        HapticEventDetector eventDetector;
+        HapticEventQueue events;
+        HapticEventScheduler haptics;
+        std::atomic<uint32_t> droppedEvents{0};
+        std::atomic<bool> running{false};
+        std::atomic<uint32_t> renderedBlocks{0};
+
+        // Probes: ingest = receive, validation and decryption of an accepted
+        // packet; effects = vibration engine, mixer and haptic events for one
+        // block; latency = datagram received until the first block using it
+        // was queued to the sink
+        Histogram ingestCycles;
+        Histogram effectsCycles;
+        Histogram latencyMicros;
+        Histogram blockIntervalMicros;
+        std::atomic<uint32_t> packetRate{0};
+        int16_t audioBlock[AUDIO_BLOCK_FRAMES * CHANNELS] = {};
+        TelemetryFrame ingestFrame = {};
+        TelemetryFrame audioFrame = {};
+        bool hasAudioFrame = false;
+        int32_t measuredPacketId = 0;
+        uint32_t previousSubmit = 0;
+};
+
+#endif
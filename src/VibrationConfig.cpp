@@ -0,0 +1,116 @@
+#include "VibrationConfig.h"
+#include "config.h"
+#include <string.h>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<VibrationConfig>::value, "the config is copied and stored as raw bytes");
+
+VibrationConfig defaultVibrationConfig() {
+    VibrationConfig config = {};
+    config.baseFrequency = BASE_FREQUENCY;
+    config.frequencyPerIntensity = FREQUENCY_PER_INTENSITY;
+    config.gearShiftFrequency = GEAR_SHIFT_FREQUENCY;
+    config.normalFrequency = NORMAL_FREQUENCY;
+    config.gearShiftDuration = GEAR_SHIFT_DURATION;
+    config.rpmMax = RPM_MAX;
+    config.rpmMin = RPM_MIN;
+    config.amplitudeFactor = AMPLITUDE_FACTOR;
+    config.frequencyDivisor = FREQUENCY_DIVISOR;
+    config.tireSlipFactor = TIRE_SLIP_FACTOR;
+    config.suspensionHeightFactor = SUSPENSION_HEIGHT_FACTOR;
+    config.tireSlipIntensity = tireSlipIntensity;
+    config.rpmIntensity = rpmIntensity;
+    config.suspHeightIntensity = suspHeightIntensity;
+    config.useTireSlip = useTireSlip;
+    config.useRPM = useRPM;
+    config.useSuspHeight = useSuspHeight;
+    return config;
+}
+
+ConfigStore::ConfigStore() : current(&slots[0]) {
+    slots[0] = defaultVibrationConfig();
+    for (auto& slot : held) {
+        slot.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+const VibrationConfig& ConfigStore::acquire(size_t reader) {
+    // Announce the slot, then make sure it is still the current one: if the
+    // writer swapped in between it may already be reusing it, so try again.
+    // Terminates as soon as the writer pauses between two publishes.
+    const VibrationConfig* config = current.load(std::memory_order_acquire);
+    for (;;) {
+        held[reader].store(config, std::memory_order_seq_cst);
+        const VibrationConfig* check = current.load(std::memory_order_seq_cst);
+        if (check == config) {
+            return *config;
+        }
+        config = check;
+    }
+}
+
+void ConfigStore::publish(const VibrationConfig& config) {
+    const VibrationConfig* active = current.load(std::memory_order_relaxed);
+    VibrationConfig* slot = nullptr;
+    for (VibrationConfig& candidate : slots) {
+        bool busy = &candidate == active;
+        for (const auto& reader : held) {
+            busy |= reader.load(std::memory_order_seq_cst) == &candidate;
+        }
+        if (!busy) {
+            slot = &candidate;
+            break;
+        }
+    }
+    *slot = config;
+    slot->version = active->version + 1;
+    current.store(slot, std::memory_order_seq_cst);
+}
+
+const VibrationConfig& ConfigStore::latest() const {
+    return *current.load(std::memory_order_acquire);
+}
+
+static uint32_t fnv1a(const uint8_t* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+void encodeConfigBlob(uint32_t magic, uint16_t layout, const void* payload, size_t size, uint8_t* blob) {
+    ConfigBlobHeader header = {};
+    header.magic = magic;
+    header.layout = layout;
+    header.size = static_cast<uint16_t>(size);
+    memcpy(blob + sizeof(header), payload, size);
+    header.checksum = fnv1a(blob + sizeof(header), size);
+    memcpy(blob, &header, sizeof(header));
+}
+
+bool decodeConfigBlob(uint32_t magic, uint16_t layout, const uint8_t* blob, size_t length, void* payload, size_t size) {
+    if (length != sizeof(ConfigBlobHeader) + size) {
+        return false;
+    }
+    ConfigBlobHeader header;
+    memcpy(&header, blob, sizeof(header));
+    const uint8_t* bytes = blob + sizeof(header);
+    if (header.magic != magic || header.layout != layout || header.size != size || header.checksum != fnv1a(bytes, size)) {
+        return false;
+    }
+    memcpy(payload, bytes, size);
+    return true;
+}
+
+bool saveVibrationConfig(ConfigStorage& storage, const VibrationConfig& config) {
+    uint8_t blob[CONFIG_BLOB_SIZE];
+    encodeConfigBlob(CONFIG_BLOB_MAGIC, VIBRATION_CONFIG_LAYOUT, &config, sizeof(config), blob);
+    return storage.save(blob, sizeof(blob));
+}
+
+bool loadVibrationConfig(ConfigStorage& storage, VibrationConfig& config) {
+    uint8_t blob[CONFIG_BLOB_SIZE];
+    size_t length = storage.load(blob, sizeof(blob));
+    return decodeConfigBlob(CONFIG_BLOB_MAGIC, VIBRATION_CONFIG_LAYOUT, blob, length, &config, sizeof(config));
+}
@@ -0,0 +1,98 @@
+#ifndef VIBRATIONCONFIG_H
+#define VIBRATIONCONFIG_H
+
+#include <atomic>
+#include <inttypes.h>
+#include <stddef.h>
+
+// All runtime tunables of the vibration engine and the haptic events in one
+// plain struct, see config.h for their meaning. config.cpp only provides the
+// defaults; the values in use come from a ConfigStore snapshot.
+struct VibrationConfig {
+    uint32_t version;              // set by ConfigStore::publish()
+    int32_t baseFrequency;
+    int32_t frequencyPerIntensity;
+    int32_t gearShiftFrequency;
+    int32_t normalFrequency;
+    int32_t gearShiftDuration;
+    int32_t rpmMax;
+    int32_t rpmMin;
+    float amplitudeFactor;
+    int32_t frequencyDivisor;
+    float tireSlipFactor;
+    float suspensionHeightFactor;
+    int32_t tireSlipIntensity;     // %
+    int32_t rpmIntensity;
+    int32_t suspHeightIntensity;
+    bool useTireSlip;
+    bool useRPM;
+    bool useSuspHeight;
+};
+
+// Bump whenever VibrationConfig changes, stored blobs of another layout are
+// ignored and the defaults are used
+constexpr uint16_t VIBRATION_CONFIG_LAYOUT = 1;
+
+// The values from config.cpp
+VibrationConfig defaultVibrationConfig();
+
+// Copy-on-write snapshots: publish() copies the new config into a free slot
+// and swaps a single atomic pointer, readers get a const reference that
+// stays valid and unchanged until their next acquire(). No locks and no
+// copies on the reader side, a reader never sees half an update.
+//
+// One writer task; each reader task uses its own reader index and announces
+// the slot it holds, so the writer never reuses it. With MAX_READERS + 2
+// slots there is always one free.
+class ConfigStore {
+    public:
+        static constexpr size_t MAX_READERS = 2;
+
+        ConfigStore();
+        // Reader side, e.g. once per audio block
+        const VibrationConfig& acquire(size_t reader);
+        // Writer side
+        void publish(const VibrationConfig& config);
+        const VibrationConfig& latest() const;
+
+    private:
+        static constexpr size_t SLOTS = MAX_READERS + 2;
+        VibrationConfig slots[SLOTS] = {};
+        std::atomic<const VibrationConfig*> current;
+        std::atomic<const VibrationConfig*> held[MAX_READERS];
+};
+
+// Key/value storage for one small blob (NVS on the ESP32, a file on the host)
+class ConfigStorage {
+    public:
+        virtual ~ConfigStorage() = default;
+        // Returns the stored length, 0 if there is nothing or it does not fit
+        virtual size_t load(uint8_t* data, size_t capacity) = 0;
+        virtual bool save(const uint8_t* data, size_t length) = 0;
+};
+
+// Blob: magic, layout, size and checksum, then the struct as it is in
+// memory. Loading is a memcpy after the checks, nothing is parsed.
+#pragma pack(push, 1)
+struct ConfigBlobHeader {
+    uint32_t magic;
+    uint16_t layout;
+    uint16_t size;
+    uint32_t checksum;  // FNV-1a of the struct bytes
+};
+#pragma pack(pop)
+
+// Writes header and payload to blob (sizeof(ConfigBlobHeader) + size bytes)
+void encodeConfigBlob(uint32_t magic, uint16_t layout, const void* payload, size_t size, uint8_t* blob);
+// Copies the payload out if magic, layout, size and checksum match
+bool decodeConfigBlob(uint32_t magic, uint16_t layout, const uint8_t* blob, size_t length, void* payload, size_t size);
+
+constexpr uint32_t CONFIG_BLOB_MAGIC = 0x56375447; // "GT7V"
+constexpr size_t CONFIG_BLOB_SIZE = sizeof(ConfigBlobHeader) + sizeof(VibrationConfig);
+
+bool saveVibrationConfig(ConfigStorage& storage, const VibrationConfig& config);
+// Leaves config untouched and returns false unless a blob of this layout
+// with a matching checksum is stored
+bool loadVibrationConfig(ConfigStorage& storage, VibrationConfig& config);
+
+#endif
@@ -0,0 +1,231 @@
+#include "VibrationEngine.h"
+#include "Log.h"
+#include "config.h" // STOP_VIBRATION_DELAY
+#include <math.h>
+#include <string.h>
+
+// Frequenzbereich des Bass Shakers
+static const int MIN_FREQUENCY = 20;
+static const int MAX_FREQUENCY = 90;
+
+// Shaker-Frequenz je Fahrbahn-Band (rauer Asphalt, Kerbs, Rüttelstreifen)
+static const float TEXTURE_FREQUENCY[TEXTURE_BANDS] = { 30, 45, 60 };
+// Band-Amplitude (m), ab der die Stimme voll ausgesteuert ist
+static const float TEXTURE_FULL_SCALE = 0.005f;
+
+// Ausgangskanal je Rad (VL, VR, HL, HR)
+static const uint8_t LEFT_RIGHT_CHANNEL[4] = { 0, 1, 0, 1 };
+static const uint8_t FRONT_REAR_CHANNEL[4] = { 0, 0, 1, 1 };
+
+// Kleinster Drehzahlbereich eines Fahrzeugprofils, ab dem er die Drehzahl-Frequenz bestimmt
+static const float MIN_PROFILE_RPM_RANGE = 1000;
+
+// Frequenz auf einen Bereich begrenzen
+static float clampFrequency(float frequency, float low, float high) {
+  return frequency < low ? low : (frequency > high ? high : frequency);
+}
+
+// Stärke eines Effekts aus seiner Lage im Frequenzbereich, 0 ohne Schlupf bzw. Federweg
+static float effectAmplitude(float frequency) {
+  return (frequency - MIN_FREQUENCY) / (MAX_FREQUENCY - MIN_FREQUENCY);
+}
+
+// Intensität des Fahrzeugprofils, sonst die globale
+static int carIntensity(int8_t carValue, int32_t globalValue) {
+  return carValue != NO_INTENSITY_OVERRIDE ? carValue : globalValue;
+}
+
+static const char* const ROUTING_NAMES[] = { "mono", "lr", "fr" };
+
+const char* channelRoutingName(ChannelRouting routing) {
+  size_t index = static_cast<size_t>(routing);
+  return index < sizeof(ROUTING_NAMES) / sizeof(ROUTING_NAMES[0]) ? ROUTING_NAMES[index] : "";
+}
+
+bool parseChannelRouting(const char* name, ChannelRouting& routing) {
+  for (size_t i = 0; i < sizeof(ROUTING_NAMES) / sizeof(ROUTING_NAMES[0]); ++i) {
+    if (strcmp(name, ROUTING_NAMES[i]) == 0) {
+      routing = static_cast<ChannelRouting>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+void VibrationEngine::attachMixer(HapticMixer& mixer) {
+  this->mixer = &mixer;
+  for (auto& weights : pan) {
+    for (float& weight : weights) {
+      weight = 1;
+    }
+  }
+  mixer.setMono(routing == ChannelRouting::Mono);
+}
+
+void VibrationEngine::setRouting(ChannelRouting routing) {
+  this->routing = routing;
+  if (mixer != nullptr) {
+    mixer->setMono(routing == ChannelRouting::Mono);
+  }
+}
+
+ChannelRouting VibrationEngine::getRouting() const {
+  return routing;
+}
+
+// Kanalgewichte aus den Anteilen der Räder, der stärkere Kanal bekommt 1
+void VibrationEngine::wheelPan(const float wheel[4], float weights[HapticMixer::MAX_CHANNELS]) const {
+  float sum[HapticMixer::MAX_CHANNELS] = {};
+  if (routing != ChannelRouting::Mono) {
+    const uint8_t* channel = routing == ChannelRouting::LeftRight ? LEFT_RIGHT_CHANNEL : FRONT_REAR_CHANNEL;
+    for (int i = 0; i < 4; ++i) {
+      sum[channel[i]] += wheel[i];
+    }
+  }
+  float loudest = 0;
+  for (float channelSum : sum) {
+    loudest = channelSum > loudest ? channelSum : loudest;
+  }
+  for (size_t c = 0; c < HapticMixer::MAX_CHANNELS; ++c) {
+    weights[c] = loudest > 0 ? sum[c] / loudest : 1;
+  }
+}
+
+const SeqlockSnapshot<VibrationState>& VibrationEngine::getState() const {
+  return state;
+}
+
+void VibrationEngine::processTelemetryData(const TelemetryFrame& frame, uint32_t now, const VibrationConfig& config) {
+  this->config = &config;
+  // Stimmen nur bei neuen Paketen neu berechnen, der Block-Takt ist schneller als GT7
+  bool newPacket = frame.packetId != processedPacketId;
+  if (newPacket) {
+    processedPacketId = frame.packetId;
+    generateVoices(frame, now);
+  }
+
+  if (frame.speed > 0) {
+    // Vibration stoppen, wenn sich die Werte nicht ändern
+    stopped = now - lastChangeTime > STOP_VIBRATION_DELAY;
+  }
+
+  // Schalter und Intensitäten bei jedem Block übernehmen, damit das Webinterface sofort wirkt
+  // Intensitäten des Fahrzeugprofils haben Vorrang
+  int suspHeightIntensity = carIntensity(frame.car.suspHeightIntensity, config.suspHeightIntensity);
+  setVoice(VibrationVoice::RPM, config.useRPM, carIntensity(frame.car.rpmIntensity, config.rpmIntensity));
+  setVoice(VibrationVoice::TireSlip, config.useTireSlip, carIntensity(frame.car.tireSlipIntensity, config.tireSlipIntensity));
+  setVoice(VibrationVoice::SuspHeight, config.useSuspHeight, suspHeightIntensity);
+  for (size_t b = 0; b < TEXTURE_BANDS; ++b) {
+    setVoice(static_cast<VibrationVoice>(static_cast<size_t>(VibrationVoice::Texture) + b), config.useSuspHeight, suspHeightIntensity);
+  }
+  // Für die Live-Ansicht, einmal pro Paket reicht
+  if (newPacket) {
+    state.publish(voiceState);
+  }
+  this->config = nullptr;
+}
+
+void VibrationEngine::setVoice(VibrationVoice voice, bool enabled, int intensity) {
+  size_t index = static_cast<size_t>(voice);
+  float level = enabled && !stopped ? amplitude[index] : 0;
+  mixer->setVoice(index, frequency[index], level, intensity / 100.0f);
+  voiceState.frequency[index] = frequency[index];
+  voiceState.level[index] = level * intensity / 100.0f;
+  mixer->setVoicePan(index, pan[index]);
+}
+
+void VibrationEngine::generateVoices(const TelemetryFrame& frame, uint32_t now) {
+  if (frame.speed <= 0) {
+    return;
+  }
+
+  float rpm = frame.rpm;
+
+  // Gesamtschlupf basierend auf der Abweichung von 1 berechnen
+  float wheelSlip[4];
+  for (int i = 0; i < 4; ++i) {
+    wheelSlip[i] = fabsf(frame.tyreSlipRatio[i] - 1);
+  }
+  float totalTireSlip = wheelSlip[0] + wheelSlip[1] + wheelSlip[2] + wheelSlip[3];
+
+  // Radbezogene Effekte auf die Shaker der betroffenen Räder legen
+  wheelPan(wheelSlip, pan[static_cast<size_t>(VibrationVoice::TireSlip)]);
+  wheelPan(frame.roadTexture, pan[static_cast<size_t>(VibrationVoice::SuspHeight)]);
+  for (size_t b = 0; b < TEXTURE_BANDS; ++b) {
+    for (size_t c = 0; c < HapticMixer::MAX_CHANNELS; ++c) {
+      pan[static_cast<size_t>(VibrationVoice::Texture) + b][c] = pan[static_cast<size_t>(VibrationVoice::SuspHeight)][c];
+    }
+  }
+
+  // Fahrbahnanregung aller Räder (Einfedergeschwindigkeit im Textur-Band), nicht die statische Höhe
+  float totalSuspHeight = frame.roadTexture[0] + frame.roadTexture[1] + frame.roadTexture[2] + frame.roadTexture[3];
+
+  if (config->useRPM) {
+    // Der Motor läuft immer, daher volle Amplitude
+    size_t index = static_cast<size_t>(VibrationVoice::RPM);
+    frequency[index] = generateAudioSignalFromRPM(rpm, frame.car);
+    amplitude[index] = 1;
+    if (rpm != lastRPM) {
+      lastRPM = rpm;
+      lastChangeTime = now; // Änderung erkannt, Timer zurücksetzen
+    }
+  }
+
+  if (config->useTireSlip) {
+    size_t index = static_cast<size_t>(VibrationVoice::TireSlip);
+    frequency[index] = generateTireSlipVibration(totalTireSlip);
+    amplitude[index] = effectAmplitude(frequency[index]);
+    if (totalTireSlip != lastTireSlip) {
+      lastTireSlip = totalTireSlip;
+      lastChangeTime = now; // Änderung erkannt, Timer zurücksetzen
+    }
+  }
+
+  if (config->useSuspHeight) {
+    size_t index = static_cast<size_t>(VibrationVoice::SuspHeight);
+    frequency[index] = generateSuspHeightVibration(totalSuspHeight);
+    amplitude[index] = effectAmplitude(frequency[index]);
+    if (totalSuspHeight != lastSuspHeight) {
+      lastSuspHeight = totalSuspHeight;
+      lastChangeTime = now; // Änderung erkannt, Timer zurücksetzen
+    }
+
+    // Periodische Anregung (Kerbs, Rüttelstreifen): eine Stimme pro Band, Stärke nach Band-Amplitude
+    for (size_t b = 0; b < TEXTURE_BANDS; ++b) {
+      size_t index = static_cast<size_t>(VibrationVoice::Texture) + b;
+      float level = frame.textureBands[b] / TEXTURE_FULL_SCALE;
+      frequency[index] = TEXTURE_FREQUENCY[b];
+      amplitude[index] = level < 1 ? level : 1;
+    }
+  }
+}
+
+int VibrationEngine::generateAudioSignalFromRPM(float rpm, const CarProfile& car) {
+  float range = car.redlineRPM - car.idleRPM;
+  float raw;
+  if (range >= MIN_PROFILE_RPM_RANGE) {
+    // Leerlauf bis Begrenzer des Fahrzeugs auf den ganzen Frequenzbereich abbilden
+    raw = MIN_FREQUENCY + (rpm - car.idleRPM) / range * (MAX_FREQUENCY - MIN_FREQUENCY);
+  } else {
+    // Drehzahlbereich noch unbekannt
+    raw = rpm / config->frequencyDivisor;
+  }
+  // Frequenz auf den Bereich des Bass Shakers begrenzen
+  int frequency = clampFrequency(raw, MIN_FREQUENCY, MAX_FREQUENCY);
+  LOG_DEBUG("RPM Frequency: %d\n", frequency);
+  return frequency;
+}
+
+int VibrationEngine::generateTireSlipVibration(float tireSlip) {
+  // Frequenz basierend auf dem Reifenschlupf berechnen
+  int frequency = clampFrequency(MIN_FREQUENCY + tireSlip * config->tireSlipFactor, MIN_FREQUENCY, MAX_FREQUENCY);
+  LOG_DEBUG("Tire Slip Frequency: %d\n", frequency);
+  return frequency;
+}
+
+int VibrationEngine::generateSuspHeightVibration(float suspHeight) {
+  // Frequenz basierend auf der Fahrbahnanregung (m/s) berechnen
+  int frequency = clampFrequency(MIN_FREQUENCY + suspHeight * config->suspensionHeightFactor, MIN_FREQUENCY, MAX_FREQUENCY);
+  LOG_DEBUG("Susp Height Frequency: %d\n", frequency);
+  return frequency;
+}
@@ -0,0 +1,86 @@
+#ifndef VIBRATIONENGINE_H
+#define VIBRATIONENGINE_H
+
+#include "Platform.h"
+#include "HapticMixer.h"
+#include "Seqlock.h"
+#include "TelemetryFrame.h"
+#include "VibrationConfig.h"
+
+// One mixer voice per effect
+enum class VibrationVoice : uint8_t {
+    RPM,
+    TireSlip,
+    SuspHeight,
+    Texture,    // one voice per road texture band, TEXTURE_BANDS in total
+    Count = Texture + TEXTURE_BANDS
+};
+
+// How the per-wheel effects (tyre slip, suspension, road texture) are spread
+// over the output channels when two shakers are connected
+enum class ChannelRouting : uint8_t {
+    Mono,      // one signal on all channels, mixed only once
+    LeftRight, // channel 0 left wheels, channel 1 right wheels
+    FrontRear  // channel 0 front axle, channel 1 rear axle
+};
+
+// Short names "mono", "lr", "fr" for command lines and settings
+const char* channelRoutingName(ChannelRouting routing);
+bool parseChannelRouting(const char* name, ChannelRouting& routing);
+
+constexpr size_t VIBRATION_VOICES = static_cast<size_t>(VibrationVoice::Count);
+static_assert(VIBRATION_VOICES <= HapticMixer::MAX_VOICES, "every vibration voice needs a mixer voice");
+
+// What the engine asked the mixer for after the last packet, for live views
+struct VibrationState {
+    float frequency[VIBRATION_VOICES]; // Hz
+    float level[VIBRATION_VOICES];     // effect amplitude * intensity, 0 when off or stopped
+};
+
+// Maps GT7 telemetry onto the continuous shaker voices, see VibrationConfig
+// for the tunables. Runs in the audio task once per block and must not block. Gear
+// shifts and other short effects are HapticEvents layered on top.
+class VibrationEngine {
+    public:
+        // One tone per VibrationVoice, attached to the mixer voice of the same index
+        template <typename Tone>
+        void begin(HapticMixer& mixer, Tone (&tones)[VIBRATION_VOICES]) {
+            for (size_t i = 0; i < VIBRATION_VOICES; ++i) {
+                mixer.attach(i, tones[i]);
+            }
+            attachMixer(mixer);
+        }
+        void setRouting(ChannelRouting routing);
+        ChannelRouting getRouting() const;
+        // config is the snapshot for this block, see ConfigStore
+        void processTelemetryData(const TelemetryFrame& frame, uint32_t now, const VibrationConfig& config);
+        // Published once per new packet, readable from any task
+        const SeqlockSnapshot<VibrationState>& getState() const;
+    private:
+        void attachMixer(HapticMixer& mixer);
+        void wheelPan(const float wheel[4], float weights[HapticMixer::MAX_CHANNELS]) const;
+        int generateAudioSignalFromRPM(float rpm, const CarProfile& car);
+        int generateTireSlipVibration(float tireSlip);
+        int generateSuspHeightVibration(float suspHeight);
+        void generateVoices(const TelemetryFrame& frame, uint32_t now);
+        void setVoice(VibrationVoice voice, bool enabled, int intensity);
+
+        HapticMixer* mixer = nullptr;
+        const VibrationConfig* config = nullptr; // only during processTelemetryData()
+        int32_t processedPacketId = 0;
+        float frequency[VIBRATION_VOICES] = {};
+        float amplitude[VIBRATION_VOICES] = {};
+        float pan[VIBRATION_VOICES][HapticMixer::MAX_CHANNELS] = {};
+        ChannelRouting routing = ChannelRouting::Mono;
+        bool stopped = false;
+        VibrationState voiceState = {};
+        SeqlockSnapshot<VibrationState> state;
+
+        // Variablen zur Überwachung von Änderungen
+        uint32_t lastChangeTime = 0;
+        float lastRPM = 0;
+        float lastTireSlip = 0;
+        float lastSuspHeight = 0;
+};
+
+#endif
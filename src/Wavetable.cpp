@@ -0,0 +1,103 @@
+#include "Wavetable.h"
+#include <math.h>
+
+#ifdef ARDUINO
+#include <esp_attr.h>
+#else
+#define IRAM_ATTR
+#endif
+
+// One guard entry so interpolation never wraps the index
+static int16_t sineTable[WavetableOscillator::TABLE_SIZE + 1];
+static int16_t triangleTable[WavetableOscillator::TABLE_SIZE + 1];
+static bool tablesReady = false;
+
+// Filled once from begin(), which runs during setup and not from the audio task
+static void buildTables() {
+    if (tablesReady) {
+        return;
+    }
+    const uint32_t size = WavetableOscillator::TABLE_SIZE;
+    for (uint32_t i = 0; i <= size; ++i) {
+        float x = static_cast<float>(i % size) / size;
+        sineTable[i] = static_cast<int16_t>(lrintf(32767.0f * sinf(2.0f * static_cast<float>(M_PI) * x)));
+        // Starts at 0 and rises like the sine
+        float triangle = x < 0.25f ? 4 * x : (x < 0.75f ? 2 - 4 * x : 4 * x - 4);
+        triangleTable[i] = static_cast<int16_t>(lrintf(32767.0f * triangle));
+    }
+    tablesReady = true;
+}
+
+void WavetableOscillator::begin(uint32_t sampleRate) {
+    buildTables();
+    this->sampleRate = sampleRate;
+    phase = 0;
+    increment = 0;
+    noiseLowPass = 0;
+    setFrequency(0);
+}
+
+void WavetableOscillator::setFrequency(float frequency) {
+    if (frequency <= 0) {
+        targetIncrement = 0;
+        noiseCoefficient = 0;
+        return;
+    }
+    targetIncrement = static_cast<uint32_t>(frequency / sampleRate * 4294967296.0f);
+    float coefficient = 1 - expf(-2.0f * static_cast<float>(M_PI) * frequency / sampleRate);
+    noiseCoefficient = static_cast<int32_t>(coefficient * 32768.0f);
+}
+
+void WavetableOscillator::setWaveform(Waveform waveform) {
+    this->waveform = waveform;
+}
+
+void WavetableOscillator::render(int16_t* samples, size_t frames, uint8_t channels) {
+    switch (waveform) {
+        case Waveform::Sine: renderTable(sineTable, samples, frames, channels); break;
+        case Waveform::Triangle: renderTable(triangleTable, samples, frames, channels); break;
+        case Waveform::Noise: renderNoise(samples, frames, channels); break;
+    }
+}
+
+IRAM_ATTR void WavetableOscillator::renderTable(const int16_t* table, int16_t* samples, size_t frames, uint8_t channels) {
+    const uint32_t fracShift = 32 - TABLE_BITS - 15;
+    uint32_t p = phase;
+    // Increments stay far below 2^31 for audible frequencies
+    int32_t step = frames > 0 ? (static_cast<int32_t>(targetIncrement) - static_cast<int32_t>(increment)) / static_cast<int32_t>(frames) : 0;
+    uint32_t inc = increment;
+    for (size_t i = 0; i < frames; ++i) {
+        uint32_t index = p >> (32 - TABLE_BITS);
+        int32_t frac = static_cast<int32_t>((p >> fracShift) & 0x7FFF);
+        int32_t a = table[index];
+        int32_t b = table[index + 1];
+        int16_t sample = static_cast<int16_t>(a + (((b - a) * frac) >> 15));
+        p += inc;
+        inc += step;
+        for (uint8_t c = 0; c < channels; ++c) {
+            *samples++ = sample;
+        }
+    }
+    phase = p;
+    increment = targetIncrement;
+}
+
+IRAM_ATTR void WavetableOscillator::renderNoise(int16_t* samples, size_t frames, uint8_t channels) {
+    uint32_t state = noiseState;
+    int32_t lowPass = noiseLowPass;
+    for (size_t i = 0; i < frames; ++i) {
+        // xorshift32
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        int32_t white = static_cast<int16_t>(state >> 16);
+        lowPass += ((white - lowPass) * noiseCoefficient) >> 15;
+        int16_t sample = static_cast<int16_t>(lowPass);
+        for (uint8_t c = 0; c < channels; ++c) {
+            *samples++ = sample;
+        }
+    }
+    noiseState = state;
+    noiseLowPass = lowPass;
+    increment = targetIncrement;
+}
@@ -0,0 +1,44 @@
+#ifndef WAVETABLE_H
+#define WAVETABLE_H
+
+#include <inttypes.h>
+#include <stddef.h>
+#include "Platform.h"
+
+enum class Waveform : uint8_t {
+    Sine,
+    Triangle,
+    Noise   // low-pass filtered white noise, frequency sets the cutoff
+};
+
+// Fixed-point oscillator: 32-bit phase accumulator (Q32 of a period) into a
+// shared Q15 table with linear interpolation. No floating point per sample;
+// setFrequency() only sets a target increment that the next render() ramps to
+// linearly, so the phase stays continuous and the pitch has no steps.
+class WavetableOscillator : public ToneGenerator {
+    public:
+        static constexpr uint32_t TABLE_BITS = 9;
+        static constexpr uint32_t TABLE_SIZE = 1u << TABLE_BITS;
+
+        explicit WavetableOscillator(Waveform waveform = Waveform::Sine) : waveform(waveform) {}
+        void begin(uint32_t sampleRate) override;
+        void setFrequency(float frequency) override;
+        void render(int16_t* samples, size_t frames, uint8_t channels) override;
+        void setWaveform(Waveform waveform);
+
+    private:
+        void renderTable(const int16_t* table, int16_t* samples, size_t frames, uint8_t channels);
+        void renderNoise(int16_t* samples, size_t frames, uint8_t channels);
+
+        Waveform waveform;
+        uint32_t sampleRate = 32000;
+        uint32_t phase = 0;
+        uint32_t increment = 0;
+        uint32_t targetIncrement = 0;
+        // Noise: xorshift state and one-pole low-pass with a Q15 coefficient
+        uint32_t noiseState = 0x12345678;
+        int32_t noiseLowPass = 0;
+        int32_t noiseCoefficient = 0;
+};
+
+#endif
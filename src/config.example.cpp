@@ -1,4 +1,3 @@
-#include <Arduino.h>
 #include "config.h"
 
 // WiFi-Konfiguration
@@ -6,13 +5,15 @@ const char* ssid = "xxxxxxxx";
 const char* password = "xxxxxxxx";
 
 // IP-Adresse als separate Bytes
-const byte ip_part1 = 192;
-const byte ip_part2 = 168;
-const byte ip_part3 = 178;
-const byte ip_part4 = 99;
+const uint8_t ip_part1 = 192;
+const uint8_t ip_part2 = 168;
+const uint8_t ip_part3 = 178;
+const uint8_t ip_part4 = 99;
 
 // IP-Adresse aus den Bytes erstellen
+#ifdef ARDUINO
 const IPAddress playstationIP(ip_part1, ip_part2, ip_part3, ip_part4);
+#endif
 
 // Vibrationseinstellungen (Standardwerte)
 int BASE_FREQUENCY = 20;
@@ -37,9 +38,5 @@ int tireSlipIntensity = 50;
 int rpmIntensity = 50;
 int suspHeightIntensity = 50;
 
-// Variablen zur Überwachung von Änderungen
-unsigned long lastChangeTime = 0;
-float lastRPM = 0;
-float lastTireSlip = 0;
-float lastSuspHeight = 0;
+// Vibration stoppen, wenn sich die Werte so lange nicht ändern (ms)
 const unsigned long STOP_VIBRATION_DELAY = 5000; // 5 Sekunden
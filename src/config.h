@@ -1,16 +1,21 @@
+#ifndef CONFIG_H
 #define CONFIG_H
 
+#include "Platform.h"
+
 // WiFi-Konfiguration
 extern const char* ssid;
 extern const char* password;
 
 // IP-Adresse als separate Bytes
-extern const byte ip_part1;
-extern const byte ip_part2;
-extern const byte ip_part3;
-extern const byte ip_part4;
+extern const uint8_t ip_part1;
+extern const uint8_t ip_part2;
+extern const uint8_t ip_part3;
+extern const uint8_t ip_part4;
 
+#ifdef ARDUINO
 extern const IPAddress playstationIP;
+#endif
 
 // Vibrationseinstellungen (Standardwerte)
 extern int BASE_FREQUENCY;
@@ -35,9 +40,7 @@ extern int tireSlipIntensity;
 extern int rpmIntensity;
 extern int suspHeightIntensity;
 
-// Variablen zur Überwachung von Änderungen
-extern unsigned long lastChangeTime;
-extern float lastRPM;
-extern float lastTireSlip;
-extern float lastSuspHeight;
+// Vibration stoppen, wenn sich die Werte so lange nicht ändern (ms)
 extern const unsigned long STOP_VIBRATION_DELAY;
+
+#endif
@@ -0,0 +1,164 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <stdarg.h>
+#include "PlatformESP32.h"
+#include "AudioTools.h"
+#include "AudioTools/AudioLibs/AudioBoardStream.h"
+
+static AudioBoardStream out(AudioKitEs8388V1);
+
+uint32_t clockMillis() {
+    return millis();
+}
+
+uint32_t clockMicros() {
+    return micros();
+}
+
+void clockDelay(uint32_t ms) {
+    delay(ms);
+}
+
+uint32_t clockCycles() {
+    return ESP.getCycleCount();
+}
+
+uint32_t clockCyclesPerMicro() {
+    return ESP.getCpuFreqMHz();
+}
+
+size_t freeHeap() {
+    return ESP.getFreeHeap();
+}
+
+bool startTask(const char* name, void (*task)(void*), void* arg, uint32_t stackSize, uint8_t priority, uint8_t core) {
+    return xTaskCreatePinnedToCore(task, name, stackSize, arg, priority, nullptr, core) == pdPASS;
+}
+
+void endTask() {
+    vTaskDelete(nullptr);
+}
+
+void logPrintf(const char* format, ...) {
+    char line[128];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    Serial.print(line);
+}
+
+bool BoardAudioSink::begin(uint32_t sampleRate, uint8_t channels) {
+    this->channels = channels;
+    this->sampleRate = sampleRate;
+    AudioInfo info(sampleRate, channels, 16);
+    auto config = out.defaultConfig(TX_MODE);
+    config.copyFrom(info);
+    uint32_t dmaFrames = static_cast<uint32_t>(config.buffer_count) * config.buffer_size / (channels * sizeof(int16_t));
+    dmaMicros = static_cast<uint32_t>(static_cast<uint64_t>(dmaFrames) * 1000000u / sampleRate);
+    return out.begin(config);
+}
+
+size_t BoardAudioSink::write(const int16_t* samples, size_t frames) {
+    // The I2S driver does not report underruns, so track when the queued
+    // audio runs out. If the DMA ring was already empty, this block is late.
+    uint32_t now = clockMicros();
+    if (started && static_cast<int32_t>(now - playedUntil) > 0) {
+        ++underruns;
+    }
+    uint32_t from = started && static_cast<int32_t>(playedUntil - now) > 0 ? playedUntil : now;
+    playedUntil = from + static_cast<uint32_t>(static_cast<uint64_t>(frames) * 1000000u / sampleRate);
+    started = true;
+
+    size_t frameSize = channels * sizeof(int16_t);
+    size_t written = out.write(reinterpret_cast<const uint8_t*>(samples), frames * frameSize) / frameSize;
+
+    // write() blocks while the ring is full, so no more than the ring is queued
+    uint32_t limit = clockMicros() + dmaMicros;
+    if (static_cast<int32_t>(playedUntil - limit) > 0) {
+        playedUntil = limit;
+    }
+    return written;
+}
+
+struct FlashCaptureStorage::Handle {
+    File file;
+    size_t unflushed = 0;
+};
+
+FlashCaptureStorage::~FlashCaptureStorage() {
+    if (handle != nullptr) {
+        handle->file.close();
+        delete handle;
+    }
+}
+
+bool FlashCaptureStorage::begin() {
+    // Formats the partition on first use
+    if (!LittleFS.begin(true)) {
+        return false;
+    }
+    handle = new Handle();
+    handle->file = LittleFS.open(path, FILE_WRITE);
+    return static_cast<bool>(handle->file);
+}
+
+bool FlashCaptureStorage::append(const uint8_t* data, size_t length) {
+    if (handle == nullptr || handle->file.write(data, length) != length) {
+        return false;
+    }
+    // The firmware never closes the file, keep at most a few KB unwritten
+    handle->unflushed += length;
+    if (handle->unflushed >= 4096) {
+        handle->file.flush();
+        handle->unflushed = 0;
+    }
+    return true;
+}
+
+static const char* const NVS_NAMESPACE = "gt7";
+static const char* const NVS_CONFIG_KEY = "config";
+static const char* const NVS_CAR_NAMESPACE = "gt7cars";
+
+static size_t loadNvsBlob(const char* space, const char* key, uint8_t* data, size_t capacity) {
+    Preferences preferences;
+    if (!preferences.begin(space, true)) {
+        return 0;
+    }
+    size_t length = preferences.getBytesLength(key);
+    length = length > 0 && length <= capacity ? preferences.getBytes(key, data, capacity) : 0;
+    preferences.end();
+    return length;
+}
+
+static bool saveNvsBlob(const char* space, const char* key, const uint8_t* data, size_t length) {
+    Preferences preferences;
+    if (!preferences.begin(space, false)) {
+        return false;
+    }
+    bool ok = preferences.putBytes(key, data, length) == length;
+    preferences.end();
+    return ok;
+}
+
+size_t NvsConfigStorage::load(uint8_t* data, size_t capacity) {
+    return loadNvsBlob(NVS_NAMESPACE, NVS_CONFIG_KEY, data, capacity);
+}
+
+bool NvsConfigStorage::save(const uint8_t* data, size_t length) {
+    return saveNvsBlob(NVS_NAMESPACE, NVS_CONFIG_KEY, data, length);
+}
+
+// NVS keys are at most 15 characters, the decimal carCode always fits
+size_t NvsCarProfileStorage::load(int32_t carCode, uint8_t* data, size_t capacity) {
+    char key[16];
+    snprintf(key, sizeof(key), "%ld", static_cast<long>(carCode));
+    return loadNvsBlob(NVS_CAR_NAMESPACE, key, data, capacity);
+}
+
+bool NvsCarProfileStorage::save(int32_t carCode, const uint8_t* data, size_t length) {
+    char key[16];
+    snprintf(key, sizeof(key), "%ld", static_cast<long>(carCode));
+    return saveNvsBlob(NVS_CAR_NAMESPACE, key, data, length);
+}
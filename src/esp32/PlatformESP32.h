@@ -0,0 +1,55 @@
+#ifndef PLATFORMESP32_H
+#define PLATFORMESP32_H
+
+#include "../Platform.h"
+#include "../CarProfileStore.h"
+#include "../PacketCapture.h"
+#include "../VibrationConfig.h"
+
+// ES8388 codec of the ESP32-Audio-Kit
+class BoardAudioSink : public AudioSink {
+    public:
+        bool begin(uint32_t sampleRate, uint8_t channels) override;
+        size_t write(const int16_t* samples, size_t frames) override;
+        uint32_t getUnderruns() const override { return underruns; }
+    private:
+        uint8_t channels = 2;
+        uint32_t sampleRate = 32000;
+        uint32_t dmaMicros = 0;
+        uint32_t playedUntil = 0;
+        bool started = false;
+        uint32_t underruns = 0;
+};
+
+// Capture file on the LittleFS flash partition. Flash writes can stall for
+// milliseconds, so captures are meant for recording sessions, not for racing.
+class FlashCaptureStorage : public CaptureStorage {
+    public:
+        explicit FlashCaptureStorage(const char* path) : path(path) {}
+        ~FlashCaptureStorage() override;
+        bool begin();
+        bool append(const uint8_t* data, size_t length) override;
+    private:
+        const char* path;
+        struct Handle;
+        Handle* handle = nullptr;
+};
+
+// Config blob in the NVS partition, survives firmware updates. An NVS
+// write stalls flash access for a few milliseconds, so save only after the
+// settings have stopped changing.
+class NvsConfigStorage : public ConfigStorage {
+    public:
+        size_t load(uint8_t* data, size_t capacity) override;
+        bool save(const uint8_t* data, size_t length) override;
+};
+
+// Car profiles in their own NVS namespace, one key per carCode. Written on
+// a car change or at standstill only, see CarProfileStore.
+class NvsCarProfileStorage : public CarProfileStorage {
+    public:
+        size_t load(int32_t carCode, uint8_t* data, size_t capacity) override;
+        bool save(int32_t carCode, const uint8_t* data, size_t length) override;
+};
+
+#endif
@@ -0,0 +1,276 @@
+#include "WebUi.h"
+#include <Arduino.h>
+
+// Labels and input types per setting, the values come from GET /api/settings.
+// Every change is posted on its own and applies at once, no page reload.
+// The car section polls GET /api/car, its overrides go to POST /api/car.
+const char WEB_UI_HTML[] PROGMEM = R"=====(<!DOCTYPE html>
+<html>
+<head>
+  <meta charset="UTF-8">
+  <meta name="viewport" content="width=device-width, initial-scale=1">
+  <title>Vibrationseinstellungen</title>
+  <style>
+    body { font-family: Arial, sans-serif; margin: 20px; background-color: black; color: white; }
+    label { display: block; margin-top: 10px; }
+    input, select { width: 100%; padding: 5px; margin-top: 5px; box-sizing: border-box; }
+    #status { margin-top: 20px; min-height: 1.2em; color: #8c8; }
+    #status.error { color: #e66; }
+    #live { width: 100%; height: 220px; background-color: #111; margin-top: 10px; }
+    #legend span { margin-right: 12px; }
+  </style>
+</head>
+<body>
+  <h1>Vibrationseinstellungen</h1>
+  <form id="settings" onsubmit="return false"></form>
+  <div id="status"></div>
+
+  <h2>Fahrzeug</h2>
+  <div id="car">Kein Fahrzeug</div>
+  <form id="carSettings" onsubmit="return false"></form>
+
+  <h2>Live</h2>
+  <select id="group"></select>
+  <div id="dash"></div>
+  <canvas id="live"></canvas>
+  <div id="legend"></div>
+
+  <script>
+    const fields = [
+      ['BASE_FREQUENCY', 'Basis-Frequenz (Hz)', 'number', 1],
+      ['FREQUENCY_PER_INTENSITY', 'Frequenz pro Intensität (Hz)', 'number', 1],
+      ['GEAR_SHIFT_FREQUENCY', 'Gangwechsel-Frequenz (Hz)', 'number', 1],
+      ['NORMAL_FREQUENCY', 'Normale Frequenz (Hz)', 'number', 1],
+      ['GEAR_SHIFT_DURATION', 'Gangwechsel-Dauer (ms)', 'number', 1],
+      ['TIRE_SLIP_FACTOR', 'Reifenschlupf-Faktor', 'number', 0.01],
+      ['SUSPENSION_HEIGHT_FACTOR', 'Federwege-Faktor', 'number', 0.01],
+      ['useTireSlip', 'Reifenschlupf verwenden', 'bool'],
+      ['useRPM', 'RPM verwenden', 'bool'],
+      ['useSuspHeight', 'Federwege verwenden', 'bool'],
+      ['tireSlipIntensity', 'Reifenschlupf-Intensität (%)', 'range'],
+      ['rpmIntensity', 'RPM-Intensität (%)', 'range'],
+      ['suspHeightIntensity', 'Federwege-Intensität (%)', 'range']
+    ];
+    const form = document.getElementById('settings');
+    const status = document.getElementById('status');
+    const inputs = {};
+
+    function showStatus(text, error) {
+      status.textContent = text;
+      status.className = error ? 'error' : '';
+    }
+
+    function show(values) {
+      for (const name in inputs) {
+        if (!(name in values) || document.activeElement === inputs[name]) continue;
+        const input = inputs[name];
+        input.value = typeof values[name] === 'boolean' ? (values[name] ? '1' : '0') : values[name];
+        if (input.output) input.output.textContent = input.value;
+      }
+    }
+
+    // Schieberegler senden höchstens alle 100 ms, der letzte Wert gewinnt
+    let pending = {};
+    let timer = null;
+    function send() {
+      timer = null;
+      const body = JSON.stringify(pending);
+      pending = {};
+      fetch('/api/settings', { method: 'POST', headers: { 'Content-Type': 'application/json' }, body: body })
+        .then(r => r.json().then(j => ({ ok: r.ok, json: j })))
+        .then(r => {
+          if (r.ok) { show(r.json); showStatus('Übernommen', false); }
+          else showStatus('Fehler: ' + r.json.error, true);
+        })
+        .catch(() => showStatus('Keine Verbindung', true));
+    }
+    function change(name, value) {
+      pending[name] = value;
+      if (!timer) timer = setTimeout(send, 100);
+    }
+
+    for (const [name, text, type, step] of fields) {
+      const label = document.createElement('label');
+      label.textContent = text + ':';
+      label.htmlFor = name;
+      form.appendChild(label);
+      let input;
+      if (type === 'bool') {
+        input = document.createElement('select');
+        input.innerHTML = '<option value="1">Ja</option><option value="0">Nein</option>';
+        input.addEventListener('change', () => change(name, input.value === '1'));
+      } else {
+        input = document.createElement('input');
+        input.type = type;
+        if (type === 'range') {
+          input.min = 0;
+          input.max = 100;
+          input.output = document.createElement('span');
+          label.appendChild(input.output);
+        } else {
+          input.step = step;
+        }
+        input.addEventListener(type === 'range' ? 'input' : 'change', () => {
+          if (input.output) input.output.textContent = input.value;
+          if (input.value !== '') change(name, Number(input.value));
+        });
+      }
+      input.id = name;
+      inputs[name] = input;
+      form.appendChild(input);
+    }
+
+    fetch('/api/settings').then(r => r.json()).then(show).catch(() => showStatus('Keine Verbindung', true));
+
+    // Intensitäten nur für das gefahrene Fahrzeug, -1 übernimmt die globale
+    const carFields = [
+      ['rpmIntensity', 'RPM-Intensität (%)'],
+      ['tireSlipIntensity', 'Reifenschlupf-Intensität (%)'],
+      ['suspHeightIntensity', 'Federwege-Intensität (%)']
+    ];
+    const carInfo = document.getElementById('car');
+    const carForm = document.getElementById('carSettings');
+    const carInputs = {};
+
+    function showCar(car) {
+      carInfo.textContent = 'Fahrzeug ' + car.carCode + ', Drehzahl ' + Math.round(car.idleRPM) + ' bis ' + Math.round(car.redlineRPM);
+      for (const name in carInputs) {
+        const input = carInputs[name];
+        if (document.activeElement === input) continue;
+        input.value = car[name];
+        input.output.textContent = car[name] < 0 ? 'global' : car[name];
+      }
+    }
+
+    for (const [name, text] of carFields) {
+      const label = document.createElement('label');
+      label.textContent = text + ':';
+      label.htmlFor = 'car-' + name;
+      const input = document.createElement('input');
+      input.type = 'range';
+      input.min = -1;
+      input.max = 100;
+      input.id = 'car-' + name;
+      input.output = document.createElement('span');
+      label.appendChild(input.output);
+      input.addEventListener('input', () => input.output.textContent = input.value < 0 ? 'global' : input.value);
+      input.addEventListener('change', () => {
+        fetch('/api/car', { method: 'POST', headers: { 'Content-Type': 'application/json' }, body: JSON.stringify({ [name]: Number(input.value) }) })
+          .then(r => r.json().then(j => ({ ok: r.ok, json: j })))
+          .then(r => {
+            if (r.ok) { showCar(r.json); showStatus('Übernommen', false); }
+            else showStatus('Fehler: ' + r.json.error, true);
+          })
+          .catch(() => showStatus('Keine Verbindung', true));
+      });
+      carInputs[name] = input;
+      carForm.appendChild(label);
+      carForm.appendChild(input);
+    }
+
+    // Das Fahrzeug wechselt im Spiel, daher regelmäßig nachfragen
+    function pollCar() {
+      fetch('/api/car').then(r => r.ok ? r.json().then(showCar) : null).catch(() => {});
+    }
+    pollCar();
+    setInterval(pollCar, 2000);
+
+    // Live-Telemetrie von Port 81, Aufbau siehe LiveTelemetry.h
+    const CHANNELS = 30, TYRE_SLIP = 6, SUSP_VELOCITY = 10, ROAD_TEXTURE = 14, VOICE_FREQUENCY = 18, VOICE_LEVEL = 24;
+    const HISTORY = 300; // 15 s bei 20 Bildern/s
+    const wheels = ['VL', 'VR', 'HL', 'HR'];
+    const voices = ['RPM', 'Schlupf', 'Federung', 'Fahrbahn 1', 'Fahrbahn 2', 'Fahrbahn 3'];
+    const groups = [
+      ['Effekte: Frequenz (Hz)', VOICE_FREQUENCY, voices, 10],
+      ['Effekte: Stärke', VOICE_LEVEL, voices, 1000],
+      ['Reifenschlupf', TYRE_SLIP, wheels, 1000],
+      ['Einfedergeschwindigkeit (m/s)', SUSP_VELOCITY, wheels, 1000],
+      ['Fahrbahnanregung (m/s)', ROAD_TEXTURE, wheels, 1000]
+    ];
+    const colors = ['#f44', '#4c4', '#48f', '#fc4', '#c4f', '#4cf'];
+    const values = new Int16Array(CHANNELS);
+    const history = new Int16Array(HISTORY * CHANNELS);
+    let samples = 0, synced = false, sequence = -1, lost = 0, dirty = false;
+    const groupSelect = document.getElementById('group');
+    groups.forEach((g, i) => groupSelect.add(new Option(g[0], i)));
+    groupSelect.addEventListener('change', () => { dirty = true; });
+
+    function receive(buffer) {
+      const d = new DataView(buffer);
+      const key = (d.getUint8(0) & 1) === 1;
+      if (d.getUint8(1) !== CHANNELS || (!key && !synced)) return;
+      const seq = d.getUint16(2, true);
+      if (sequence >= 0) lost += (seq - sequence - 1) & 0xffff;
+      sequence = seq;
+      const mask = d.getUint32(4, true);
+      let p = 8;
+      for (let c = 0; c < CHANNELS; ++c) {
+        if (((mask >>> c) & 1) === 0) continue;
+        let z = 0, shift = 0, b;
+        do { b = d.getUint8(p++); z |= (b & 0x7f) << shift; shift += 7; } while (b & 0x80);
+        const delta = (z >>> 1) ^ -(z & 1);
+        values[c] = key ? delta : values[c] + delta;
+      }
+      synced = true;
+      history.set(values, (samples % HISTORY) * CHANNELS);
+      ++samples;
+      dirty = true;
+    }
+
+    function draw() {
+      requestAnimationFrame(draw);
+      if (!dirty) return;
+      dirty = false;
+      const gear = values[2] & 0xff, suggested = values[2] >> 8;
+      document.getElementById('dash').textContent = (values[0] / 10).toFixed(0) + ' km/h  ' + values[1] + ' U/min  Gang ' +
+        gear + (suggested !== 15 ? ' (' + suggested + ')' : '') + '  Gas ' + values[3] + '  Bremse ' + values[4] +
+        '  Flags 0x' + (values[5] & 0xffff).toString(16) + '  verloren ' + lost;
+      const [, first, names, scale] = groups[groupSelect.value];
+      const canvas = document.getElementById('live');
+      canvas.width = canvas.clientWidth;
+      canvas.height = canvas.clientHeight;
+      const ctx = canvas.getContext('2d');
+      const count = Math.min(samples, HISTORY);
+      let low = 0, high = 0;
+      for (let i = 0; i < count; ++i) {
+        for (let n = 0; n < names.length; ++n) {
+          const v = history[i * CHANNELS + first + n];
+          low = Math.min(low, v);
+          high = Math.max(high, v);
+        }
+      }
+      if (high === low) high = low + 1;
+      const y = v => canvas.height - 4 - (v - low) / (high - low) * (canvas.height - 8);
+      ctx.strokeStyle = '#444';
+      ctx.beginPath(); ctx.moveTo(0, y(0)); ctx.lineTo(canvas.width, y(0)); ctx.stroke();
+      const legend = document.getElementById('legend');
+      legend.innerHTML = '';
+      for (let n = 0; n < names.length; ++n) {
+        ctx.strokeStyle = colors[n];
+        ctx.beginPath();
+        for (let i = 0; i < count; ++i) {
+          const v = history[((samples - count + i) % HISTORY) * CHANNELS + first + n];
+          const x = i * canvas.width / (HISTORY - 1);
+          if (i === 0) ctx.moveTo(x, y(v)); else ctx.lineTo(x, y(v));
+        }
+        ctx.stroke();
+        const entry = document.createElement('span');
+        entry.style.color = colors[n];
+        entry.textContent = names[n] + ' ' + (values[first + n] / scale).toFixed(scale > 10 ? 3 : 1);
+        legend.appendChild(entry);
+      }
+    }
+
+    function connect() {
+      const socket = new WebSocket('ws://' + location.hostname + ':81/');
+      socket.binaryType = 'arraybuffer';
+      socket.onopen = () => { synced = false; sequence = -1; };
+      socket.onmessage = e => receive(e.data);
+      socket.onclose = () => setTimeout(connect, 2000);
+    }
+    connect();
+    requestAnimationFrame(draw);
+  </script>
+</body>
+</html>
+)=====";
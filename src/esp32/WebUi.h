@@ -0,0 +1,9 @@
+#ifndef WEBUI_H
+#define WEBUI_H
+
+// Settings page, a constant in flash sent as is. It loads and changes the
+// settings through /api/settings, see Settings.h, and plots the live
+// telemetry from the WebSocket on port 81, see LiveTelemetry.h.
+extern const char WEB_UI_HTML[];
+
+#endif
@@ -1,42 +1,76 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <WebServer.h>
+#include <WebSocketsServer.h>
 #include "GT7UDPParser.h"
-#include "AudioTools.h"
-#include "AudioTools/AudioLibs/AudioBoardStream.h"
+#include "LiveTelemetry.h"
+#include "Log.h"
+#include "PacketCapture.h"
+#include "Settings.h"
+#include "SocketPacketSource.h"
+#include "TelemetryPipeline.h"
+#include "VibrationEngine.h"
+#include "Wavetable.h"
+#include "esp32/PlatformESP32.h"
+#include "esp32/WebUi.h"
 #include "config.h"
 
 // Webserver
 WebServer server(80);
+// Live-Telemetrie für die Webseite, binär über WebSocket
+WebSocketsServer liveSocket(81);
+LiveTelemetryEncoder liveEncoder;
 
 // Globale Variablen
+SocketPacketSource udpSource(ip_part1, ip_part2, ip_part3, ip_part4);
+#ifdef GT7_CAPTURE_PATH
+// Mitschnitt aller Pakete in den Flash, siehe README
+FlashCaptureStorage captureStorage(GT7_CAPTURE_PATH);
+CapturingPacketSource packetSource(udpSource, captureStorage);
+#else
+PacketSource& packetSource = udpSource;
+#endif
 GT7_UDP_Parser gt7Telem;
-Packet packetContent;
+VibrationEngine vibration;
+TelemetryPipeline pipeline;
+NvsConfigStorage configStorage;
+NvsCarProfileStorage carProfileStorage;
 
-unsigned long previousT = 0;
-const long interval = 500;
-uint8_t previousGear = 0;
 const int LED_PIN = 2;
+const uint8_t WEB_PRIORITY = 1;
+const uint32_t WEB_STACK_SIZE = 8192;
+const uint8_t LIVE_PRIORITY = 1;
+const uint32_t LIVE_STACK_SIZE = 4096;
+const uint32_t LIVE_INTERVAL_MS = 50; // höchstens 20 Bilder/s
+const uint32_t CONFIG_SAVE_DELAY_MS = 5000; // erst speichern, wenn nicht mehr eingestellt wird
+const float CONFIG_SAVE_MAX_KMH = 1; // gespeichert wird nur im Stand ...
+const uint32_t TELEMETRY_IDLE_MICROS = 2000000; // ... oder wenn keine Telemetrie mehr kommt
+
+// Zuletzt geänderte Einstellungen noch nicht gespeichert (nur Web-Task)
+bool configUnsaved = false;
+uint32_t configChangedAt = 0;
 
 // Audio-Generierung
-AudioInfo info(32000, 2, 16);
-SineWaveGenerator<int16_t> sineWave(32000);
-GeneratedSoundStream<int16_t> sound(sineWave);
-AudioBoardStream out(AudioKitEs8388V1);
-StreamCopy copier(out, sound);
+WavetableOscillator tones[VIBRATION_VOICES];
+HapticMixer mixer;
+BoardAudioSink out;
 
 // Funktionsdeklarationen
-void processTelemetryData(Packet packetContent);
-int generateAudioSignalFromRPM(float rpm);
-int generateTireSlipVibration(float tireSlip);
-int generateSuspHeightVibration(float suspHeight);
-void generateGearChangeVibration();
+void webTask(void* arg);
+bool configSaveAllowed();
+void liveTask(void* arg);
 void printTelemetry(float speed, float rpm, int intensity);
 void handleRoot();
-void handleUpdate();
+void handleGetSettings();
+void handlePostSettings();
+void sendJsonError(int code, const char* error);
+void handleGetCar();
+void handlePostCar();
+void handleMetrics();
 
 void setup() {
   Serial.begin(115200);
+  logStart(INGEST_CORE); // Log-Ausgabe mit niedriger Priorität, nie aus dem Audio-Task
 
   // WiFi verbinden
   WiFi.begin(ssid, password);
@@ -47,141 +81,100 @@ void setup() {
 
   // Webserver starten
   server.on("/", handleRoot);      // Hauptseite
-  server.on("/update", handleUpdate); // Parameter aktualisieren
+  server.on("/api/settings", HTTP_GET, handleGetSettings);   // Einstellungen lesen
+  server.on("/api/settings", HTTP_POST, handlePostSettings); // Einstellungen ändern, ohne Neuladen der Seite
+  server.on("/api/car", HTTP_GET, handleGetCar);   // Profil des gefahrenen Fahrzeugs
+  server.on("/api/car", HTTP_POST, handlePostCar); // Intensitäten nur für dieses Fahrzeug
+  server.on("/metrics", handleMetrics); // Latenzen und Zähler für Prometheus
   server.begin();
   Serial.println("Webserver gestartet");
 
   // Audio initialisieren
-  auto config = out.defaultConfig(TX_MODE);
-  config.copyFrom(info);
-  out.begin(config);
-  sineWave.begin(info, N_C0);
-  sineWave.setFrequency(0);
+  out.begin(SAMPLE_RATE, CHANNELS);
+  mixer.begin(SAMPLE_RATE);
+  vibration.begin(mixer, tones); // Eine Stimme pro Effekt
+  vibration.setRouting(ChannelRouting::Mono); // Zwei Shaker: ChannelRouting::LeftRight oder ChannelRouting::FrontRear
 
   // GT7 Telemetrie initialisieren
-  gt7Telem.begin(playstationIP);
-  gt7Telem.sendHeartbeat();
+#ifdef GT7_CAPTURE_PATH
+  if (!captureStorage.begin()) Serial.println("Mitschnitt nicht möglich");
+#endif
+  gt7Telem.begin(packetSource);
+  gt7Telem.setIngestMode(IngestMode::LatestWins); // Rückstau nach Hängern verwerfen
+  gt7Telem.setPacketVariant(GT7PacketVariant::Tilde); // Heartbeat '~': 344-Byte-Pakete mit Lenkwinkel und Beschleunigungen
+
+  // Empfang und Webserver auf Core 0 (WiFi), Audio mit hoher Priorität auf Core 1
+  pipeline.begin(gt7Telem, vibration, mixer, out);
+  // Gespeicherte Einstellungen aus dem NVS, sonst die Standardwerte aus der config.cpp
+  VibrationConfig storedConfig = pipeline.getConfig().latest();
+  if (loadVibrationConfig(configStorage, storedConfig)) {
+    pipeline.getConfig().publish(storedConfig);
+    Serial.println("Einstellungen geladen");
+  }
+  // Fahrzeugprofile (Drehzahlbereich, Intensitäten) je carCode im NVS
+  pipeline.getCarProfiles().begin(&carProfileStorage);
+  pipeline.start();
+  startTask("web", webTask, nullptr, WEB_STACK_SIZE, WEB_PRIORITY, INGEST_CORE);
+  startTask("live", liveTask, nullptr, LIVE_STACK_SIZE, LIVE_PRIORITY, INGEST_CORE);
 }
 
 void loop() {
-  server.handleClient(); // Webserver-Anfragen verarbeiten
-
-  unsigned long currentT = millis();
-  packetContent = gt7Telem.readData();
-  processTelemetryData(packetContent);
+  // Alles läuft in eigenen Tasks
+  vTaskDelete(nullptr);
+}
 
-  if (currentT - previousT >= interval) {
-    previousT = currentT;
-    gt7Telem.sendHeartbeat();
+void webTask(void* arg) {
+  for (;;) {
+    server.handleClient(); // Webserver-Anfragen verarbeiten
+    if (configUnsaved && millis() - configChangedAt >= CONFIG_SAVE_DELAY_MS && configSaveAllowed()) {
+      configUnsaved = false;
+      if (!saveVibrationConfig(configStorage, pipeline.getConfig().latest())) LOG_WARN("Einstellungen nicht gespeichert\n");
+    }
+    delay(2);
   }
-  copier.copy();
 }
 
-void processTelemetryData(Packet packetContent) {
-  float speed = packetContent.packetContent.speed * 3.6;
-  float rpm = packetContent.packetContent.EngineRPM;
-
-  float tireSlip1 = gt7Telem.getTyreSlipRatio(0);
-  float tireSlip2 = gt7Telem.getTyreSlipRatio(1);
-  float tireSlip3 = gt7Telem.getTyreSlipRatio(2);
-  float tireSlip4 = gt7Telem.getTyreSlipRatio(3);
-
-  // Gesamtschlupf basierend auf der Abweichung von 1 berechnen
-  float totalTireSlip = abs(tireSlip1 - 1) + abs(tireSlip2 - 1) + abs(tireSlip3 - 1) + abs(tireSlip4 - 1);
-
-  // Federwege
-  float suspHeight1 = packetContent.packetContent.suspHeight[0];
-  float suspHeight2 = packetContent.packetContent.suspHeight[1];
-  float suspHeight3 = packetContent.packetContent.suspHeight[2];
-  float suspHeight4 = packetContent.packetContent.suspHeight[3];
-  float totalSuspHeight = abs(suspHeight1) + abs(suspHeight2) + abs(suspHeight3) + abs(suspHeight4);
-
-  // Gangwechsel überprüfen
-  uint8_t currentGear = packetContent.packetContent.gears & 0b00001111;
-  if (currentGear != previousGear) {
-    generateGearChangeVibration();
-    previousGear = currentGear;
+// Das Schreiben in den NVS blockiert den Flash-Cache und damit kurz auch den
+// Audio-Task; während der Fahrt bleibt die Änderung deshalb vorgemerkt.
+bool configSaveAllowed() {
+  TelemetryFrame telemetry;
+  if (pipeline.getTelemetry().version() == 0 || !pipeline.getTelemetry().read(telemetry)) {
+    return pipeline.getTelemetry().version() == 0; // Schreiber aktiv: später erneut versuchen
   }
+  return telemetry.speed < CONFIG_SAVE_MAX_KMH || clockMicros() - telemetry.receivedMicros >= TELEMETRY_IDLE_MICROS;
+}
 
-  // Frequenz und Amplitude für den Bass Shaker setzen
-  if (speed > 0) {
-    int frequency = NORMAL_FREQUENCY;
-
-    if (useRPM) {
-      frequency = generateAudioSignalFromRPM(rpm);
-      if (rpm != lastRPM) {
-        lastRPM = rpm;
-        lastChangeTime = millis(); // Änderung erkannt, Timer zurücksetzen
-      }
-    }
-
-    if (useTireSlip) {
-      int tireSlipFrequency = generateTireSlipVibration(totalTireSlip);
-      if (totalTireSlip != lastTireSlip) {
-        lastTireSlip = totalTireSlip;
-        lastChangeTime = millis(); // Änderung erkannt, Timer zurücksetzen
-      }
-      if (useRPM) {
-        // Gewichteter Durchschnitt der beiden Frequenzen berechnen
-        frequency = (frequency * rpmIntensity + tireSlipFrequency * tireSlipIntensity) / (rpmIntensity + tireSlipIntensity);
-      } else {
-        frequency = tireSlipFrequency;
-      }
-    }
-
-    if (useSuspHeight) {
-      int suspHeightFrequency = generateSuspHeightVibration(totalSuspHeight);
-      if (totalSuspHeight != lastSuspHeight) {
-        lastSuspHeight = totalSuspHeight;
-        lastChangeTime = millis(); // Änderung erkannt, Timer zurücksetzen
-      }
-      if (useRPM || useTireSlip) {
-        // Gewichteter Durchschnitt der Frequenzen berechnen
-        frequency = (frequency * (rpmIntensity + tireSlipIntensity) + suspHeightFrequency * suspHeightIntensity) / (rpmIntensity + tireSlipIntensity + suspHeightIntensity);
-      } else {
-        frequency = suspHeightFrequency;
+// Eigener Task, damit ein langsamer Client weder die Einstellungen noch
+// Empfang oder Audio aufhält. Gesendet wird immer nur das neueste Paket,
+// was dazwischen ankommt oder nicht gelesen werden kann, fällt weg.
+void liveTask(void* arg) {
+  static uint8_t frame[LiveTelemetryEncoder::MAX_FRAME_BYTES];
+  uint32_t sentVersion = 0;
+  uint32_t lastSent = 0;
+  liveSocket.onEvent([](uint8_t client, WStype_t type, uint8_t* payload, size_t length) {
+    if (type == WStype_CONNECTED) liveEncoder.requestKeyFrame(); // Neuer Client braucht alle Kanäle
+  });
+  liveSocket.begin();
+  for (;;) {
+    liveSocket.loop();
+    uint32_t now = millis();
+    uint32_t version = pipeline.getTelemetry().version();
+    if (version != sentVersion && now - lastSent >= LIVE_INTERVAL_MS && liveSocket.connectedClients() > 0) {
+      TelemetryFrame telemetry;
+      VibrationState voices = {};
+      if (pipeline.getTelemetry().read(telemetry)) {
+        vibration.getState().read(voices);
+        int16_t values[LIVE_CHANNELS];
+        LiveTelemetryEncoder::quantize(telemetry, voices, values);
+        liveSocket.broadcastBIN(frame, liveEncoder.encode(values, frame));
+        sentVersion = version;
+        lastSent = now;
       }
     }
-
-    // Vibration stoppen, wenn sich die Werte nicht ändern
-    if (millis() - lastChangeTime > STOP_VIBRATION_DELAY) {
-      sineWave.setFrequency(0); // Vibration stoppen
-    } else {
-      sineWave.setFrequency(frequency);
-    }
+    delay(5);
   }
 }
 
-int generateAudioSignalFromRPM(float rpm) {
-  // Frequenz auf einen sinnvollen Bereich begrenzen (10 Hz bis 100 Hz)
-  int frequency = constrain(rpm / FREQUENCY_DIVISOR, 20, 90);
-  Serial.print("RPM Frequency: ");
-  Serial.println(frequency);
-  return frequency;
-}
-
-int generateTireSlipVibration(float tireSlip) {
-  // Frequenz basierend auf dem Reifenschlupf berechnen
-  int frequency = constrain(20 + tireSlip * TIRE_SLIP_FACTOR, 20, 90);
-  Serial.print("Tire Slip Frequency: ");
-  Serial.println(frequency);
-  return frequency;
-}
-
-int generateSuspHeightVibration(float suspHeight) {
-  // Frequenz basierend auf den Federwegen berechnen
-  int frequency = constrain(20 + suspHeight * SUSPENSION_HEIGHT_FACTOR, 20, 90);
-  Serial.print("Susp Height Frequency: ");
-  Serial.println(frequency);
-  return frequency;
-}
-
-void generateGearChangeVibration() {
-  sineWave.setFrequency(GEAR_SHIFT_FREQUENCY);
-  delay(GEAR_SHIFT_DURATION);
-  sineWave.setFrequency(NORMAL_FREQUENCY);
-}
-
 void printTelemetry(float speed, float rpm, int intensity) {
   Serial.print("Speed: ");
   Serial.print(speed);
@@ -192,149 +185,82 @@ void printTelemetry(float speed, float rpm, int intensity) {
   Serial.println("%");
 }
 
-// Webserver-Handler für die Hauptseite
+// Webserver-Handler für die Hauptseite: konstante Seite aus dem Flash
 void handleRoot() {
-  String html = R"=====(
-<!DOCTYPE html>
-<html>
-<head>
-  <meta charset="UTF-8">
-  <title>Vibrationseinstellungen</title>
-  <style>
-    body { font-family: Arial, sans-serif; margin: 20px; background-color: black; color: white; }
-    label { display: block; margin-top: 10px; }
-    input { width: 100%; padding: 5px; margin-top: 5px; }
-    button { margin-top: 20px; padding: 10px 20px; }
-  </style>
-</head>
-<body>
-  <h1>Vibrationseinstellungen</h1>
-  <form action="/update" method="GET">
-    <label for="base_freq">Basis-Frequenz (Hz):</label>
-    <input type="number" id="base_freq" name="base_freq" value=")=====";
-  html += BASE_FREQUENCY;
-  html += R"=====(">
-
-    <label for="freq_per_int">Frequenz pro Intensität (Hz):</label>
-    <input type="number" id="freq_per_int" name="freq_per_int" value=")=====";
-  html += FREQUENCY_PER_INTENSITY;
-  html += R"=====(">
-
-    <label for="gear_shift_freq">Gangwechsel-Frequenz (Hz):</label>
-    <input type="number" id="gear_shift_freq" name="gear_shift_freq" value=")=====";
-  html += GEAR_SHIFT_FREQUENCY;
-  html += R"=====(">
-
-    <label for="normal_freq">Normale Frequenz (Hz):</label>
-    <input type="number" id="normal_freq" name="normal_freq" value=")=====";
-  html += NORMAL_FREQUENCY;
-  html += R"=====(">
-
-    <label for="gear_shift_dur">Gangwechsel-Dauer (ms):</label>
-    <input type="number" id="gear_shift_dur" name="gear_shift_dur" value=")=====";
-  html += GEAR_SHIFT_DURATION;
-  html += R"=====(">
-
-    <label for="tire_slip_factor">Reifenschlupf-Faktor:</label>
-    <input type="number" step="0.01" id="tire_slip_factor" name="tire_slip_factor" value=")=====";
-  html += TIRE_SLIP_FACTOR;
-  html += R"=====(">
-
-    <label for="suspension_height_factor">Federwege-Faktor:</label>
-    <input type="number" step="0.01" id="suspension_height_factor" name="suspension_height_factor" value=")=====";
-  html += SUSPENSION_HEIGHT_FACTOR;
-  html += R"=====(">
-
-    <label for="use_tire_slip">Reifenschlupf verwenden:</label>
-    <select id="use_tire_slip" name="use_tire_slip">
-      <option value="1" )=====";
-  html += useTireSlip ? "selected" : "";
-  html += R"=====(>Ja</option>
-      <option value="0" )=====";
-  html += !useTireSlip ? "selected" : "";
-  html += R"=====(>Nein</option>
-    </select>
-
-    <label for="use_rpm">RPM verwenden:</label>
-    <select id="use_rpm" name="use_rpm">
-      <option value="1" )=====";
-  html += useRPM ? "selected" : "";
-  html += R"=====(>Ja</option>
-      <option value="0" )=====";
-  html += !useRPM ? "selected" : "";
-  html += R"=====(>Nein</option>
-    </select>
-
-    <label for="use_susp_height">Federwege verwenden:</label>
-    <select id="use_susp_height" name="use_susp_height">
-      <option value="1" )=====";
-  html += useSuspHeight ? "selected" : "";
-  html += R"=====(>Ja</option>
-      <option value="0" )=====";
-  html += !useSuspHeight ? "selected" : "";
-  html += R"=====(>Nein</option>
-    </select>
-
-    <label for="tire_slip_intensity">Reifenschlupf-Intensität (%):</label>
-    <input type="range" id="tire_slip_intensity" name="tire_slip_intensity" min="0" max="100" value=")=====";
-  html += tireSlipIntensity;
-  html += R"=====(">
-    <span id="tire_slip_intensity_value">)=====";
-  html += tireSlipIntensity;
-  html += R"=====(</span>%
+  server.send_P(200, "text/html", WEB_UI_HTML);
+}
 
-    <label for="rpm_intensity">RPM-Intensität (%):</label>
-    <input type="range" id="rpm_intensity" name="rpm_intensity" min="0" max="100" value=")=====";
-  html += rpmIntensity;
-  html += R"=====(">
-    <span id="rpm_intensity_value">)=====";
-  html += rpmIntensity;
-  html += R"=====(</span>%
+// Aktuelle Einstellungen als JSON
+void handleGetSettings() {
+  // Statischer Puffer, der Web-Task läuft allein
+  static char json[768];
+  size_t length = formatSettingsJson(pipeline.getConfig().latest(), json, sizeof(json));
+  server.send_P(200, "application/json", json, length);
+}
 
-    <label for="susp_height_intensity">Federwege-Intensität (%):</label>
-    <input type="range" id="susp_height_intensity" name="susp_height_intensity" min="0" max="100" value=")=====";
-  html += suspHeightIntensity;
-  html += R"=====(">
-    <span id="susp_height_intensity_value">)=====";
-  html += suspHeightIntensity;
-  html += R"=====(</span>%
+// Einstellungen ändern, Body z. B. {"rpmIntensity":80}; ungültige Anfragen ändern nichts.
+// Geändert wird eine Kopie, der Audio-Task bekommt sie mit dem nächsten Block als Ganzes.
+void handlePostSettings() {
+  const String& body = server.arg("plain");
+  VibrationConfig changed = pipeline.getConfig().latest();
+  SettingResult result = applySettingsJson(changed, body.c_str(), body.length());
+  if (result != SettingResult::Ok) {
+    sendJsonError(400, settingResultName(result));
+    return;
+  }
+  pipeline.getConfig().publish(changed);
+  configUnsaved = true;
+  configChangedAt = millis();
+  handleGetSettings();
+}
 
-    <button type="submit">Aktualisieren</button>
-  </form>
+// Fehler als {"error":"..."}, wie die übrigen Antworten ohne String auf dem Heap
+void sendJsonError(int code, const char* error) {
+  static char json[64];
+  size_t length = snprintf(json, sizeof(json), "{\"error\":\"%s\"}", error);
+  server.send_P(code, "application/json", json, length);
+}
 
-  <script>
-    document.getElementById('tire_slip_intensity').addEventListener('input', function() {
-      document.getElementById('tire_slip_intensity_value').textContent = this.value;
-    });
-    document.getElementById('rpm_intensity').addEventListener('input', function() {
-      document.getElementById('rpm_intensity_value').textContent = this.value;
-    });
-    document.getElementById('susp_height_intensity').addEventListener('input', function() {
-      document.getElementById('susp_height_intensity_value').textContent = this.value;
-    });
-  </script>
-</body>
-</html>
-)=====";
-  server.send(200, "text/html", html);
+// Profil des zuletzt empfangenen Fahrzeugs: gelernter Drehzahlbereich und Intensitäten (-1: global)
+void handleGetCar() {
+  static char json[192];
+  TelemetryFrame telemetry;
+  if (pipeline.getTelemetry().version() == 0 || !pipeline.getTelemetry().read(telemetry)) {
+    sendJsonError(404, "no car");
+    return;
+  }
+  size_t length = formatCarProfileJson(telemetry.car, json, sizeof(json));
+  server.send_P(200, "application/json", json, length);
 }
 
-// Webserver-Handler für die Parameteraktualisierung
-void handleUpdate() {
-  if (server.hasArg("base_freq")) BASE_FREQUENCY = server.arg("base_freq").toInt();
-  if (server.hasArg("freq_per_int")) FREQUENCY_PER_INTENSITY = server.arg("freq_per_int").toInt();
-  if (server.hasArg("gear_shift_freq")) GEAR_SHIFT_FREQUENCY = server.arg("gear_shift_freq").toInt();
-  if (server.hasArg("normal_freq")) NORMAL_FREQUENCY = server.arg("normal_freq").toInt();
-  if (server.hasArg("gear_shift_dur")) GEAR_SHIFT_DURATION = server.arg("gear_shift_dur").toInt();
-  if (server.hasArg("tire_slip_factor")) TIRE_SLIP_FACTOR = server.arg("tire_slip_factor").toFloat();
-  if (server.hasArg("suspension_height_factor")) SUSPENSION_HEIGHT_FACTOR = server.arg("suspension_height_factor").toFloat();
-  if (server.hasArg("use_tire_slip")) useTireSlip = server.arg("use_tire_slip").toInt() == 1;
-  if (server.hasArg("use_rpm")) useRPM = server.arg("use_rpm").toInt() == 1;
-  if (server.hasArg("use_susp_height")) useSuspHeight = server.arg("use_susp_height").toInt() == 1;
-  if (server.hasArg("tire_slip_intensity")) tireSlipIntensity = server.arg("tire_slip_intensity").toInt();
-  if (server.hasArg("rpm_intensity")) rpmIntensity = server.arg("rpm_intensity").toInt();
-  if (server.hasArg("susp_height_intensity")) suspHeightIntensity = server.arg("susp_height_intensity").toInt();
+// Intensitäten für das gefahrene Fahrzeug, Body z. B. {"rpmIntensity":60}. Der Empfangs-Task
+// übernimmt sie mit dem nächsten Paket und speichert sie mit dem Profil.
+void handlePostCar() {
+  static char json[192];
+  TelemetryFrame telemetry;
+  if (pipeline.getTelemetry().version() == 0 || !pipeline.getTelemetry().read(telemetry)) {
+    sendJsonError(404, "no car");
+    return;
+  }
+  const String& body = server.arg("plain");
+  CarProfile changed = telemetry.car;
+  SettingResult result = applyCarSettingsJson(changed, body.c_str(), body.length());
+  if (result != SettingResult::Ok) {
+    sendJsonError(400, settingResultName(result));
+    return;
+  }
+  CarOverrides overrides = { changed.carCode, changed.rpmIntensity, changed.tireSlipIntensity, changed.suspHeightIntensity };
+  if (!pipeline.getCarProfiles().requestOverrides(overrides)) {
+    sendJsonError(503, "busy");
+    return;
+  }
+  size_t length = formatCarProfileJson(changed, json, sizeof(json));
+  server.send_P(200, "application/json", json, length);
+}
 
-  server.sendHeader("Location", "/");
-  server.send(303);
+void handleMetrics() {
+  // Statischer Puffer, der Web-Task läuft allein
+  static char metrics[3072];
+  size_t length = pipeline.formatMetrics(metrics, sizeof(metrics));
+  server.send_P(200, "text/plain; version=0.0.4", metrics, length);
 }
@@ -0,0 +1,303 @@
+#include "PlatformNative.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <thread>
+#include <vector>
+#include <math.h>
+#include <stdarg.h>
+#include <time.h>
+
+static uint64_t monotonicMicros() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000u + ts.tv_nsec / 1000;
+}
+
+// Both clocks start at zero like millis()/micros() after reset
+static const uint64_t clockEpoch = monotonicMicros();
+
+uint32_t clockMillis() {
+    return static_cast<uint32_t>((monotonicMicros() - clockEpoch) / 1000);
+}
+
+uint32_t clockMicros() {
+    return static_cast<uint32_t>(monotonicMicros() - clockEpoch);
+}
+
+uint32_t clockCycles() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint32_t>(static_cast<uint64_t>(ts.tv_sec) * 1000000000u + ts.tv_nsec);
+}
+
+uint32_t clockCyclesPerMicro() {
+    return 1000;
+}
+
+size_t freeHeap() {
+    return 0;
+}
+
+void clockDelay(uint32_t ms) {
+    timespec ts = { static_cast<time_t>(ms / 1000), static_cast<long>(ms % 1000) * 1000000L };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+static std::vector<std::thread> tasks;
+
+// Priorities need root on Linux and are ignored; pinning keeps the two-core
+// split of the firmware so the scheduling can be stress-tested on a PC.
+bool startTask(const char* name, void (*task)(void*), void* arg, uint32_t stackSize, uint8_t priority, uint8_t core) {
+    tasks.emplace_back(task, arg);
+    pthread_setname_np(tasks.back().native_handle(), name);
+    unsigned cores = std::thread::hardware_concurrency();
+    if (cores > 1) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(core % cores, &cpus);
+        pthread_setaffinity_np(tasks.back().native_handle(), sizeof(cpus), &cpus);
+    }
+    return true;
+}
+
+void endTask() {
+}
+
+void joinTasks() {
+    for (std::thread& task : tasks) {
+        task.join();
+    }
+    tasks.clear();
+}
+
+void logPrintf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+}
+
+FileAudioSink::~FileAudioSink() {
+    if (file != nullptr) {
+        fclose(file);
+    }
+}
+
+bool FileAudioSink::begin(uint32_t sampleRate, uint8_t channels) {
+    this->channels = channels;
+    file = fopen(path, "wb");
+    return file != nullptr;
+}
+
+size_t FileAudioSink::write(const int16_t* samples, size_t frames) {
+    if (file == nullptr) {
+        return 0;
+    }
+    return fwrite(samples, channels * sizeof(int16_t), frames, file);
+}
+
+// Canonical 44 byte header, host and WAV are both little endian
+struct WavHeader {
+    char riff[4];
+    uint32_t riffSize;
+    char wave[4];
+    char fmt[4];
+    uint32_t fmtSize;
+    uint16_t format;
+    uint16_t channels;
+    uint32_t sampleRate;
+    uint32_t byteRate;
+    uint16_t blockAlign;
+    uint16_t bitsPerSample;
+    char data[4];
+    uint32_t dataSize;
+};
+static_assert(sizeof(WavHeader) == 44, "WAV header must not be padded");
+
+WavAudioSink::~WavAudioSink() {
+    close();
+}
+
+bool WavAudioSink::begin(uint32_t sampleRate, uint8_t channels) {
+    this->channels = channels;
+    file = fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    uint16_t blockAlign = static_cast<uint16_t>(channels * sizeof(int16_t));
+    WavHeader header = {
+        { 'R', 'I', 'F', 'F' }, 36, { 'W', 'A', 'V', 'E' }, { 'f', 'm', 't', ' ' }, 16,
+        1, channels, sampleRate, sampleRate * blockAlign, blockAlign, 16,
+        { 'd', 'a', 't', 'a' }, 0
+    };
+    dataBytes = 0;
+    return fwrite(&header, sizeof(header), 1, file) == 1;
+}
+
+size_t WavAudioSink::write(const int16_t* samples, size_t frames) {
+    if (file == nullptr) {
+        return 0;
+    }
+    size_t written = fwrite(samples, channels * sizeof(int16_t), frames, file);
+    dataBytes += static_cast<uint32_t>(written * channels * sizeof(int16_t));
+    return written;
+}
+
+bool WavAudioSink::close() {
+    if (file == nullptr) {
+        return true;
+    }
+    uint32_t riffSize = 36 + dataBytes;
+    bool ok = fseek(file, offsetof(WavHeader, riffSize), SEEK_SET) == 0 && fwrite(&riffSize, 4, 1, file) == 1 &&
+              fseek(file, offsetof(WavHeader, dataSize), SEEK_SET) == 0 && fwrite(&dataBytes, 4, 1, file) == 1;
+    ok = fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
+
+FileCaptureStorage::~FileCaptureStorage() {
+    if (file != nullptr) {
+        fclose(file);
+    }
+}
+
+bool FileCaptureStorage::open(const char* path) {
+    file = fopen(path, "wb");
+    return file != nullptr;
+}
+
+bool FileCaptureStorage::append(const uint8_t* data, size_t length) {
+    return file != nullptr && fwrite(data, 1, length, file) == length;
+}
+
+static size_t loadFileBlob(const char* path, uint8_t* data, size_t capacity) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        return 0;
+    }
+    // One byte more than fits tells a longer file from an exact one
+    size_t length = fread(data, 1, capacity, file);
+    bool longer = fgetc(file) != EOF;
+    fclose(file);
+    return longer ? 0 : length;
+}
+
+static bool saveFileBlob(const char* path, const uint8_t* data, size_t length) {
+    // Written next to it and renamed, a crash leaves the old or the new file
+    char temporary[512];
+    if (snprintf(temporary, sizeof(temporary), "%s.tmp", path) >= static_cast<int>(sizeof(temporary))) {
+        return false;
+    }
+    FILE* file = fopen(temporary, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool ok = fwrite(data, 1, length, file) == length;
+    ok = fclose(file) == 0 && ok;
+    return ok && rename(temporary, path) == 0;
+}
+
+size_t FileConfigStorage::load(uint8_t* data, size_t capacity) {
+    return loadFileBlob(path, data, capacity);
+}
+
+bool FileConfigStorage::save(const uint8_t* data, size_t length) {
+    return saveFileBlob(path, data, length);
+}
+
+bool FileCarProfileStorage::profilePath(int32_t carCode, char* path, size_t size) const {
+    int written = snprintf(path, size, "%s/car%ld.bin", directory, static_cast<long>(carCode));
+    return written > 0 && static_cast<size_t>(written) < size;
+}
+
+size_t FileCarProfileStorage::load(int32_t carCode, uint8_t* data, size_t capacity) {
+    char path[480];
+    return profilePath(carCode, path, sizeof(path)) ? loadFileBlob(path, data, capacity) : 0;
+}
+
+bool FileCarProfileStorage::save(int32_t carCode, const uint8_t* data, size_t length) {
+    char path[480];
+    return profilePath(carCode, path, sizeof(path)) && saveFileBlob(path, data, length);
+}
+
+MappedFile::~MappedFile() {
+    if (bytes != nullptr) {
+        munmap(const_cast<uint8_t*>(bytes), length);
+    }
+}
+
+bool MappedFile::open(const char* path) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0 && st.st_size > 0;
+    if (ok) {
+        void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ok = mapped != MAP_FAILED;
+        if (ok) {
+            bytes = static_cast<const uint8_t*>(mapped);
+            length = static_cast<size_t>(st.st_size);
+            madvise(mapped, length, MADV_SEQUENTIAL);
+        }
+    }
+    close(fd);
+    return ok;
+}
+
+bool PacedAudioSink::begin(uint32_t sampleRate, uint8_t channels) {
+    this->sampleRate = sampleRate;
+    writtenFrames = 0;
+    return target.begin(sampleRate, channels);
+}
+
+size_t PacedAudioSink::write(const int16_t* samples, size_t frames) {
+    if (writtenFrames == 0) {
+        startMicros = monotonicMicros();
+    }
+    // Frames already written but not yet played form the "DMA buffer"
+    uint64_t playedFrames = (monotonicMicros() - startMicros) * sampleRate / 1000000;
+    if (writtenFrames < playedFrames) {
+        ++underruns;
+        writtenFrames = playedFrames;
+    }
+    size_t accepted = target.write(samples, frames);
+    writtenFrames += frames;
+    uint64_t bufferedFrames = writtenFrames - playedFrames;
+    if (bufferedFrames > 2 * frames) {
+        uint64_t waitMicros = (bufferedFrames - 2 * frames) * 1000000 / sampleRate;
+        timespec ts = { static_cast<time_t>(waitMicros / 1000000), static_cast<long>(waitMicros % 1000000) * 1000L };
+        nanosleep(&ts, nullptr);
+    }
+    return accepted;
+}
+
+void SineTone::begin(uint32_t sampleRate) {
+    this->sampleRate = static_cast<float>(sampleRate);
+    phase = 0;
+    phaseIncrement = 0;
+}
+
+void SineTone::setFrequency(float frequency) {
+    phaseIncrement = 2.0f * static_cast<float>(M_PI) * frequency / sampleRate;
+}
+
+void SineTone::render(int16_t* samples, size_t frames, uint8_t channels) {
+    for (size_t i = 0; i < frames; ++i) {
+        int16_t sample = static_cast<int16_t>(amplitude * sinf(phase));
+        phase += phaseIncrement;
+        if (phase > 2.0f * static_cast<float>(M_PI)) {
+            phase -= 2.0f * static_cast<float>(M_PI);
+        }
+        for (uint8_t c = 0; c < channels; ++c) {
+            *samples++ = sample;
+        }
+    }
+}
@@ -0,0 +1,121 @@
+#ifndef PLATFORMNATIVE_H
+#define PLATFORMNATIVE_H
+
+#include <stdio.h>
+#include "../Platform.h"
+#include "../CarProfileStore.h"
+#include "../PacketCapture.h"
+#include "../VibrationConfig.h"
+
+// Waits for all tasks from startTask(), which must return on their own
+void joinTasks();
+
+// Raw interleaved s16le written to a file
+class FileAudioSink : public AudioSink {
+    public:
+        explicit FileAudioSink(const char* path) : path(path) {}
+        ~FileAudioSink() override;
+        bool begin(uint32_t sampleRate, uint8_t channels) override;
+        size_t write(const int16_t* samples, size_t frames) override;
+    private:
+        const char* path;
+        FILE* file = nullptr;
+        uint8_t channels = 2;
+};
+
+// 16-bit PCM WAV file, the sizes in the header are filled in by close()
+class WavAudioSink : public AudioSink {
+    public:
+        explicit WavAudioSink(const char* path) : path(path) {}
+        ~WavAudioSink() override;
+        bool begin(uint32_t sampleRate, uint8_t channels) override;
+        size_t write(const int16_t* samples, size_t frames) override;
+        bool close();
+    private:
+        const char* path;
+        FILE* file = nullptr;
+        uint8_t channels = 2;
+        uint32_t dataBytes = 0;
+};
+
+// Discards everything, for profiling the rest of the pipeline
+class NullAudioSink : public AudioSink {
+    public:
+        bool begin(uint32_t, uint8_t) override { return true; }
+        size_t write(const int16_t*, size_t frames) override { return frames; }
+};
+
+// Blocks in write() until the frames are due, like the I2S DMA of the board,
+// and counts the blocks that arrived too late to be played without a gap
+class PacedAudioSink : public AudioSink {
+    public:
+        explicit PacedAudioSink(AudioSink& target) : target(target) {}
+        bool begin(uint32_t sampleRate, uint8_t channels) override;
+        size_t write(const int16_t* samples, size_t frames) override;
+        uint32_t getUnderruns() const override { return underruns; }
+    private:
+        AudioSink& target;
+        uint32_t sampleRate = 32000;
+        uint64_t startMicros = 0;
+        uint64_t writtenFrames = 0;
+        uint32_t underruns = 0;
+};
+
+// Capture written to a plain file
+class FileCaptureStorage : public CaptureStorage {
+    public:
+        ~FileCaptureStorage() override;
+        bool open(const char* path);
+        bool append(const uint8_t* data, size_t length) override;
+    private:
+        FILE* file = nullptr;
+};
+
+// Config blob in a plain file, replaced atomically by save()
+class FileConfigStorage : public ConfigStorage {
+    public:
+        explicit FileConfigStorage(const char* path) : path(path) {}
+        size_t load(uint8_t* data, size_t capacity) override;
+        bool save(const uint8_t* data, size_t length) override;
+    private:
+        const char* path;
+};
+
+// Car profiles as car<carCode>.bin in an existing directory
+class FileCarProfileStorage : public CarProfileStorage {
+    public:
+        explicit FileCarProfileStorage(const char* directory) : directory(directory) {}
+        size_t load(int32_t carCode, uint8_t* data, size_t capacity) override;
+        bool save(int32_t carCode, const uint8_t* data, size_t length) override;
+    private:
+        bool profilePath(int32_t carCode, char* path, size_t size) const;
+        const char* directory;
+};
+
+// Read-only memory mapping of a whole file, for replaying captures
+class MappedFile {
+    public:
+        ~MappedFile();
+        bool open(const char* path);
+        const uint8_t* data() const { return bytes; }
+        size_t size() const { return length; }
+    private:
+        const uint8_t* bytes = nullptr;
+        size_t length = 0;
+};
+
+// Per-sample sinf(), the reference for the wavetable oscillator benchmark
+class SineTone : public ToneGenerator {
+    public:
+        explicit SineTone(float amplitude = 32000) : amplitude(amplitude) {}
+        void begin(uint32_t sampleRate) override;
+        void setFrequency(float frequency) override;
+        void render(int16_t* samples, size_t frames, uint8_t channels) override;
+    private:
+        float amplitude;
+        float sampleRate = 32000;
+        float phase = 0;
+        float phaseIncrement = 0;
+};
+
+#endif
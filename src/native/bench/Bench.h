@@ -0,0 +1,40 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <stdint.h>
+
+// Runs fn in growing batches until at least minSeconds have elapsed and
+// returns the mean time per call in nanoseconds.
+template <typename F>
+double benchNsPerCall(F fn, double minSeconds = 0.5) {
+    using Clock = std::chrono::steady_clock;
+    uint64_t calls = 0;
+    uint64_t batch = 1;
+    double elapsed = 0;
+    Clock::time_point start = Clock::now();
+    while (elapsed < minSeconds) {
+        for (uint64_t i = 0; i < batch; ++i) {
+            fn();
+        }
+        calls += batch;
+        batch *= 2;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    return elapsed * 1e9 / static_cast<double>(calls);
+}
+
+// Keeps the optimizer from discarding a benchmarked result
+template <typename T>
+inline void benchKeep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+void benchSalsa20();
+void benchMixer();
+void benchWavetable();
+void benchHistory();
+void benchTexture();
+void benchConfig();
+
+#endif
@@ -0,0 +1,145 @@
+// ConfigStore under load: two reader threads acquire while the writer
+// publishes as fast as it can, then the cost of acquire and publish, and
+// that rejected JSON requests leave the config untouched.
+
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include "Bench.h"
+#include "../../Settings.h"
+#include "../../VibrationConfig.h"
+
+static const uint32_t STRESS_PUBLISHES = 200000;
+
+// Every numeric field carries the same stamp, so a torn or reused slot
+// shows up as a mismatch
+static VibrationConfig stamped(uint32_t stamp) {
+    VibrationConfig config = defaultVibrationConfig();
+    int32_t value = static_cast<int32_t>(stamp);
+    config.baseFrequency = value;
+    config.frequencyPerIntensity = value;
+    config.gearShiftFrequency = value;
+    config.normalFrequency = value;
+    config.gearShiftDuration = value;
+    config.rpmMax = value;
+    config.rpmMin = value;
+    config.amplitudeFactor = static_cast<float>(stamp);
+    config.frequencyDivisor = value;
+    config.tireSlipIntensity = value;
+    config.rpmIntensity = value;
+    config.suspHeightIntensity = value;
+    return config;
+}
+
+static bool consistent(const VibrationConfig& config, uint32_t firstVersion) {
+    int32_t value = config.baseFrequency;
+    return config.frequencyPerIntensity == value && config.gearShiftFrequency == value &&
+           config.normalFrequency == value && config.gearShiftDuration == value &&
+           config.rpmMax == value && config.rpmMin == value &&
+           config.amplitudeFactor == static_cast<float>(value) && config.frequencyDivisor == value &&
+           config.tireSlipIntensity == value && config.rpmIntensity == value &&
+           config.suspHeightIntensity == value &&
+           config.version == firstVersion + static_cast<uint32_t>(value);
+}
+
+// Readers check each snapshot twice, before and after a pause in which the
+// writer keeps publishing: a held slot must neither tear nor be reused.
+static bool verifyConcurrentReaders() {
+    static ConfigStore store;
+    store.publish(stamped(0));
+    const uint32_t firstVersion = store.latest().version;
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> failures(0);
+    uint32_t acquired[ConfigStore::MAX_READERS] = {};
+
+    auto reader = [&](size_t index) {
+        int32_t previous = 0;
+        while (!done.load(std::memory_order_relaxed)) {
+            const VibrationConfig& config = store.acquire(index);
+            VibrationConfig first = config;
+            for (int spin = 0; spin < 64; ++spin) {
+                benchKeep(spin);
+            }
+            bool ok = consistent(first, firstVersion) && memcmp(&first, &config, sizeof(first)) == 0 &&
+                      first.baseFrequency >= previous;
+            if (!ok) {
+                failures.fetch_add(1, std::memory_order_relaxed);
+            }
+            previous = first.baseFrequency;
+            ++acquired[index];
+        }
+    };
+    std::thread readers[ConfigStore::MAX_READERS];
+    for (size_t i = 0; i < ConfigStore::MAX_READERS; ++i) {
+        readers[i] = std::thread(reader, i);
+    }
+    for (uint32_t stamp = 1; stamp <= STRESS_PUBLISHES; ++stamp) {
+        store.publish(stamped(stamp));
+    }
+    done = true;
+    for (std::thread& thread : readers) {
+        thread.join();
+    }
+
+    printf("%u publishes, %u + %u acquires, %u inconsistent\n", STRESS_PUBLISHES, acquired[0], acquired[1],
+           failures.load());
+    return failures.load() == 0 && consistent(store.latest(), firstVersion) &&
+           store.latest().baseFrequency == static_cast<int32_t>(STRESS_PUBLISHES);
+}
+
+// Each request has a valid member before the bad one, which must not be
+// applied either
+static bool verifyRejectedRequests() {
+    static const struct {
+        const char* json;
+        SettingResult expected;
+    } requests[] = {
+        { "{\"rpmIntensity\":80,", SettingResult::Malformed },
+        { "{\"rpmIntensity\":80 \"useRPM\":true}", SettingResult::Malformed },
+        { "{\"rpmIntensity\":80,\"useRPM\":true", SettingResult::Malformed },
+        { "{\"rpmIntensity\":80,\"RPM_MAX\":20001}", SettingResult::OutOfRange },
+        { "{\"rpmIntensity\":80,\"AMPLITUDE_FACTOR\":-0.5}", SettingResult::OutOfRange },
+        { "{\"rpmIntensity\":80,\"AMPLITUDE_FACTOR\":nan}", SettingResult::OutOfRange },
+        { "{\"rpmIntensity\":80,\"TIRE_SLIP_FACTOR\":NaN}", SettingResult::OutOfRange },
+        { "{\"rpmIntensity\":80,\"BASE_FREQUENCY\":12.5}", SettingResult::InvalidValue },
+        { "{\"rpmIntensity\":80,\"noSuchSetting\":1}", SettingResult::UnknownName },
+    };
+    bool ok = true;
+    for (const auto& request : requests) {
+        VibrationConfig before = defaultVibrationConfig();
+        before.rpmIntensity = 20;
+        VibrationConfig config = before;
+        SettingResult result = applySettingsJson(config, request.json, strlen(request.json));
+        bool unchanged = memcmp(&before, &config, sizeof(config)) == 0;
+        if (result != request.expected || !unchanged) {
+            printf("%s: %s%s\n", request.json, settingResultName(result), unchanged ? "" : ", config changed");
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void benchConfig() {
+    bool readersOk = verifyConcurrentReaders();
+    printf("two readers during publishes consistent: %s\n", readersOk ? "yes" : "NO");
+    bool rejectsOk = verifyRejectedRequests();
+    printf("rejected settings leave the config unchanged: %s\n", rejectsOk ? "yes" : "NO");
+
+    static ConfigStore store;
+    VibrationConfig config = defaultVibrationConfig();
+    double acquireNs = benchNsPerCall([&] {
+        benchKeep(store.acquire(0).rpmIntensity);
+    });
+    double publishNs = benchNsPerCall([&] {
+        store.publish(config);
+    });
+    const char json[] = "{\"rpmIntensity\":80,\"AMPLITUDE_FACTOR\":0.5,\"useRPM\":true}";
+    double applyNs = benchNsPerCall([&] {
+        applySettingsJson(config, json, sizeof(json) - 1);
+        benchKeep(config);
+    });
+    printf("config acquire            %6.1f ns/block\n", acquireNs);
+    printf("config publish            %6.1f ns/change  (%zu bytes)\n", publishNs, sizeof(VibrationConfig));
+    printf("settings JSON, 3 members  %6.1f ns/request\n", applyNs);
+}
@@ -0,0 +1,44 @@
+// Cost per packet of the rolling telemetry history: pushing one frame, and
+// mean, variance and rate over the four suspension columns.
+
+#include <math.h>
+#include <stdio.h>
+#include "Bench.h"
+#include "../../TelemetryHistory.h"
+
+void benchHistory() {
+    static TelemetryHistory history;
+    TelemetryFrame frame = {};
+    uint32_t packet = 0;
+    auto nextFrame = [&] {
+        ++packet;
+        frame.receivedMicros = packet * 16667;
+        frame.rpm = 3000 + 10.0f * (packet % 400);
+        for (int i = 0; i < 4; ++i) {
+            frame.suspHeight[i] = 0.08f + 0.01f * sinf(0.7f * packet + i);
+        }
+    };
+    for (size_t i = 0; i < TelemetryHistory::CAPACITY; ++i) {
+        nextFrame();
+        history.push(frame);
+    }
+
+    double pushNs = benchNsPerCall([&] {
+        nextFrame();
+        history.push(frame);
+    });
+    printf("history push              %6.1f ns/packet  (%zu bytes)\n", pushNs, sizeof(TelemetryHistory));
+
+    const size_t windows[] = { 16, TelemetryHistory::CAPACITY };
+    for (size_t n : windows) {
+        double windowNs = benchNsPerCall([&] {
+            float result = 0;
+            for (uint8_t i = 0; i < 4; ++i) {
+                HistoryChannel channel = wheelChannel(HistoryChannel::SuspHeight, i);
+                result += history.mean(channel, n) + history.variance(channel, n) + history.rate(channel, n);
+            }
+            benchKeep(result);
+        });
+        printf("4 wheels mean/var/rate %3zu %6.1f ns/packet\n", n, windowNs);
+    }
+}
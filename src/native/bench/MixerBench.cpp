@@ -0,0 +1,49 @@
+// Cost of one audio block: the old single sinf() tone against the per-effect
+// mixer running wavetable voices, mono and routed to two channels.
+
+#include <stdio.h>
+#include "Bench.h"
+#include "../PlatformNative.h"
+#include "../../HapticMixer.h"
+#include "../../TelemetryPipeline.h"
+#include "../../Wavetable.h"
+
+void benchMixer() {
+    static int16_t block[AUDIO_BLOCK_FRAMES * CHANNELS];
+    const double blockNs = 1e9 * AUDIO_BLOCK_FRAMES / SAMPLE_RATE;
+
+    SineTone single;
+    single.begin(SAMPLE_RATE);
+    single.setFrequency(55);
+    double singleNs = benchNsPerCall([&] {
+        single.render(block, AUDIO_BLOCK_FRAMES, CHANNELS);
+        benchKeep(block);
+    });
+    printf("single tone     %8.0f ns/block  %5.2f %% of real time\n", singleNs, 100 * singleNs / blockNs);
+
+    WavetableOscillator tones[HapticMixer::MAX_VOICES];
+    HapticMixer mixer;
+    mixer.begin(SAMPLE_RATE);
+    for (size_t voices = 1; voices <= HapticMixer::MAX_VOICES; ++voices) {
+        mixer.attach(voices - 1, tones[voices - 1]);
+        mixer.setVoice(voices - 1, 30.0f + 15 * voices, 0.8f, 0.5f);
+        double mixNs = benchNsPerCall([&] {
+            mixer.render(block, AUDIO_BLOCK_FRAMES, CHANNELS);
+            benchKeep(block);
+        });
+        printf("mixer %zu voices  %8.0f ns/block  %5.2f %% of real time  headroom %.2f\n",
+               voices, mixNs, 100 * mixNs / blockNs, mixer.getHeadroomGain());
+    }
+
+    // Two shakers: every voice weighted into both channels
+    const float weights[HapticMixer::MAX_CHANNELS] = { 1.0f, 0.5f };
+    for (size_t voice = 0; voice < HapticMixer::MAX_VOICES; ++voice) {
+        mixer.setVoicePan(voice, weights);
+    }
+    mixer.setMono(false);
+    double stereoNs = benchNsPerCall([&] {
+        mixer.render(block, AUDIO_BLOCK_FRAMES, CHANNELS);
+        benchKeep(block);
+    });
+    printf("stereo %zu voices %8.0f ns/block  %5.2f %% of real time\n", HapticMixer::MAX_VOICES, stereoNs, 100 * stereoNs / blockNs);
+}
@@ -0,0 +1,67 @@
+// Road texture detector per packet: Goertzel bands on the history columns
+// against a direct DFT of the same bins with sinf()/cosf() per sample.
+
+#include <math.h>
+#include <stdio.h>
+#include "Bench.h"
+#include "../../GT7UDPParser.h"
+#include "../../RoadTextureDetector.h"
+
+// Same bins, same window length, no window function
+static void directDft(const TelemetryHistory& history, const RoadTextureConfig& config, float amplitudes[TEXTURE_BANDS]) {
+    const size_t n = RoadTextureDetector::WINDOW;
+    for (size_t b = 0; b < TEXTURE_BANDS; ++b) {
+        float w = 2 * static_cast<float>(M_PI) * config.bandHz[b] / gt7PacketRate;
+        amplitudes[b] = 0;
+        for (uint8_t wheel = 0; wheel < 4; ++wheel) {
+            const float* x = history.window(wheelChannel(HistoryChannel::SuspHeight, wheel), n);
+            float re = 0, im = 0;
+            for (size_t i = 0; i < n; ++i) {
+                re += x[i] * cosf(w * i);
+                im -= x[i] * sinf(w * i);
+            }
+            float amplitude = 2 * sqrtf(re * re + im * im) / n;
+            amplitudes[b] = amplitude > amplitudes[b] ? amplitude : amplitudes[b];
+        }
+    }
+}
+
+void benchTexture() {
+    static TelemetryHistory history;
+    TelemetryFrame frame = {};
+    uint32_t packet = 0;
+    auto nextFrame = [&] {
+        ++packet;
+        frame.packetId = static_cast<int32_t>(packet);
+        // Kerb at 12 Hz on the left wheels over 0.08 m ride height
+        for (int i = 0; i < 4; ++i) {
+            frame.suspHeight[i] = 0.08f + (i % 2 == 0 ? 0.004f * sinf(2 * static_cast<float>(M_PI) * 12 * packet / gt7PacketRate) : 0);
+        }
+        history.push(frame);
+    };
+    for (size_t i = 0; i < TelemetryHistory::CAPACITY; ++i) {
+        nextFrame();
+    }
+
+    RoadTextureConfig config;
+    RoadTextureDetector detector;
+    detector.configure(config);
+    detector.process(history, frame);
+    printf("bands");
+    for (size_t b = 0; b < TEXTURE_BANDS; ++b) {
+        printf("  %.0f Hz %.2f mm", config.bandHz[b], 1000 * frame.textureBands[b]);
+    }
+    printf("  (4.00 mm at 12 Hz in the input)\n");
+
+    double goertzelNs = benchNsPerCall([&] {
+        detector.process(history, frame);
+        benchKeep(frame);
+    });
+    double dftNs = benchNsPerCall([&] {
+        float amplitudes[TEXTURE_BANDS];
+        directDft(history, config, amplitudes);
+        benchKeep(amplitudes);
+    });
+    printf("goertzel %zu bands, 5 channels  %7.1f ns/packet\n", TEXTURE_BANDS, goertzelNs);
+    printf("direct dft %zu bands, 4 channels %7.1f ns/packet  %.1fx\n", TEXTURE_BANDS, dftNs, dftNs / goertzelNs);
+}
@@ -0,0 +1,66 @@
+// Wavetable oscillators against per-sample sinf(), N voices per audio block.
+
+#include <math.h>
+#include <stdio.h>
+#include "Bench.h"
+#include "../PlatformNative.h"
+#include "../../TelemetryPipeline.h"
+#include "../../Wavetable.h"
+
+static const size_t MAX_BENCH_VOICES = 8;
+
+// Largest deviation from an exact sine over a few periods, in LSB
+static int maxSineError() {
+    static int16_t block[AUDIO_BLOCK_FRAMES];
+    WavetableOscillator oscillator;
+    oscillator.begin(SAMPLE_RATE);
+    const float frequency = 47.5f;
+    oscillator.setFrequency(frequency);
+    oscillator.render(block, 0, 1); // skip the glide from 0 Hz
+    int maxError = 0;
+    size_t n = 0;
+    for (int b = 0; b < 64; ++b) {
+        oscillator.render(block, AUDIO_BLOCK_FRAMES, 1);
+        for (size_t i = 0; i < AUDIO_BLOCK_FRAMES; ++i, ++n) {
+            // The phase increment is truncated to 32 bits, compare against the same
+            uint32_t increment = static_cast<uint32_t>(frequency / SAMPLE_RATE * 4294967296.0f);
+            double phase = static_cast<uint32_t>(increment * n) / 4294967296.0;
+            int exact = static_cast<int>(lrint(32767.0 * sin(2 * M_PI * phase)));
+            int error = abs(exact - block[i]);
+            maxError = error > maxError ? error : maxError;
+        }
+    }
+    return maxError;
+}
+
+template <typename Tone>
+static double benchVoices(Tone* tones, size_t voices) {
+    static int16_t block[AUDIO_BLOCK_FRAMES];
+    for (size_t v = 0; v < voices; ++v) {
+        tones[v].begin(SAMPLE_RATE);
+        tones[v].setFrequency(25.0f + 10 * v);
+    }
+    return benchNsPerCall([&] {
+        for (size_t v = 0; v < voices; ++v) {
+            tones[v].render(block, AUDIO_BLOCK_FRAMES, 1);
+            benchKeep(block);
+        }
+    });
+}
+
+void benchWavetable() {
+    printf("max sine error %d LSB\n", maxSineError());
+
+    static SineTone sines[MAX_BENCH_VOICES];
+    static WavetableOscillator tables[MAX_BENCH_VOICES];
+    for (size_t voices = 1; voices <= MAX_BENCH_VOICES; voices *= 2) {
+        double sineNs = benchVoices(sines, voices);
+        double tableNs = benchVoices(tables, voices);
+        printf("%zu voices  sinf %8.0f ns/block  wavetable %8.0f ns/block  %5.1fx\n",
+               voices, sineNs, tableNs, sineNs / tableNs);
+    }
+
+    static WavetableOscillator shapes[2] = { WavetableOscillator(Waveform::Triangle), WavetableOscillator(Waveform::Noise) };
+    printf("triangle %8.0f ns/block\n", benchVoices(&shapes[0], 1));
+    printf("noise    %8.0f ns/block\n", benchVoices(&shapes[1], 1));
+}
@@ -0,0 +1,35 @@
+// Host micro benchmarks for the hot paths of the receiver.
+//
+//   bench [name...]   runs all benchmarks, or only the named ones
+
+#include <stdio.h>
+#include <string.h>
+#include "Bench.h"
+
+struct BenchEntry {
+    const char* name;
+    void (*run)();
+};
+
+static const BenchEntry benches[] = {
+    { "salsa20", benchSalsa20 },
+    { "mixer", benchMixer },
+    { "wavetable", benchWavetable },
+    { "history", benchHistory },
+    { "texture", benchTexture },
+    { "config", benchConfig },
+};
+
+int main(int argc, char** argv) {
+    for (const BenchEntry& bench : benches) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i) {
+            selected |= strcmp(argv[i], bench.name) == 0;
+        }
+        if (selected) {
+            printf("== %s\n", bench.name);
+            bench.run();
+        }
+    }
+    return 0;
+}
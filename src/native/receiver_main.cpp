@@ -0,0 +1,165 @@
+// Host build of the receiver: same parser, vibration engine and task layout
+// as the firmware (ingest and audio in their own threads), fed from a POSIX
+// UDP socket or a capture file and rendering into a file or nowhere at
+// real-time pace.
+//
+//   receiver [-p playstation-ip] [-v A|B|~] [-m mono|lr|fr] [-C config.bin] [-K profiles-dir] [-o out.raw] [-d seconds] [-c record.gt7c]
+//   receiver -r capture.gt7c [-s speed] [-m mono|lr|fr] [-C config.bin] [-K profiles-dir] [-o out.raw]
+//
+// -m routes the per-wheel effects to left/right or front/rear channel, -C
+// loads a stored config (e.g. written by render -W) instead of config.cpp.
+// -K keeps the learned car profiles in a directory, one file per car.
+// -v picks the heartbeat and with it the packet layout ('~' by default, a
+// replay uses the layout of the capture). -s 1 replays in real time, 4 four
+// times faster, 0 as fast as possible.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "PlatformNative.h"
+#include "../GT7UDPParser.h"
+#include "../Log.h"
+#include "../SocketPacketSource.h"
+#include "../TelemetryPipeline.h"
+#include "../VibrationEngine.h"
+#include "../Wavetable.h"
+#include "../config.h"
+
+int main(int argc, char** argv) {
+    char defaultHost[16];
+    snprintf(defaultHost, sizeof(defaultHost), "%u.%u.%u.%u", ip_part1, ip_part2, ip_part3, ip_part4);
+    const char* host = defaultHost;
+    const char* outPath = nullptr;
+    const char* capturePath = nullptr;
+    const char* replayPath = nullptr;
+    float replaySpeed = 1;
+    uint32_t durationMs = 0;
+    const char* variantName = nullptr;
+    ChannelRouting routing = ChannelRouting::Mono;
+    const char* configPath = nullptr;
+    const char* profileDir = nullptr;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "p:v:m:C:K:o:d:c:r:s:")) != -1) {
+        switch (opt) {
+            case 'p': host = optarg; break;
+            case 'v': variantName = optarg; break;
+            case 'm':
+                if (!parseChannelRouting(optarg, routing)) {
+                    fprintf(stderr, "unknown routing %s\n", optarg);
+                    return 2;
+                }
+                break;
+            case 'C': configPath = optarg; break;
+            case 'K': profileDir = optarg; break;
+            case 'o': outPath = optarg; break;
+            case 'd': durationMs = static_cast<uint32_t>(atof(optarg) * 1000); break;
+            case 'c': capturePath = optarg; break;
+            case 'r': replayPath = optarg; break;
+            case 's': replaySpeed = static_cast<float>(atof(optarg)); break;
+            default:
+                fprintf(stderr, "usage: %s [-p playstation-ip] [-v A|B|~] [-m mono|lr|fr] [-C config.bin] [-K profiles-dir] [-o out.raw] [-d seconds] [-c record.gt7c] [-r replay.gt7c [-s speed]]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    SocketPacketSource udpSource(host);
+    FileCaptureStorage captureFile;
+    CapturingPacketSource capturingSource(udpSource, captureFile);
+    MappedFile replayFile;
+    if (replayPath != nullptr && !replayFile.open(replayPath)) {
+        fprintf(stderr, "cannot map %s\n", replayPath);
+        return 1;
+    }
+    ReplayPacketSource replaySource(replayFile.data(), replayFile.size(), replaySpeed);
+    if (capturePath != nullptr && !captureFile.open(capturePath)) {
+        fprintf(stderr, "cannot create %s\n", capturePath);
+        return 1;
+    }
+    PacketSource& source = replayPath != nullptr ? static_cast<PacketSource&>(replaySource) :
+                           capturePath != nullptr ? static_cast<PacketSource&>(capturingSource) : udpSource;
+
+    FileAudioSink fileSink(outPath != nullptr ? outPath : "");
+    NullAudioSink nullSink;
+    PacedAudioSink out(outPath != nullptr ? static_cast<AudioSink&>(fileSink) : nullSink);
+    WavetableOscillator tones[VIBRATION_VOICES];
+    HapticMixer mixer;
+    GT7_UDP_Parser gt7Telem;
+    VibrationEngine vibration;
+    TelemetryPipeline pipeline;
+
+    if (!out.begin(SAMPLE_RATE, CHANNELS)) {
+        fprintf(stderr, "cannot open %s\n", outPath);
+        return 1;
+    }
+    mixer.begin(SAMPLE_RATE);
+    vibration.begin(mixer, tones);
+    vibration.setRouting(routing);
+    gt7Telem.begin(source);
+    // Unpaced replay decodes every packet instead of only the newest
+    gt7Telem.setIngestMode(replayPath != nullptr && replaySpeed <= 0 ? IngestMode::Single : IngestMode::LatestWins);
+    if (replayPath != nullptr && replaySource.finished()) {
+        fprintf(stderr, "%s is not a capture file\n", replayPath);
+        return 1;
+    }
+    GT7PacketVariant variant = GT7PacketVariant::Tilde;
+    bool knownVariant = true;
+    if (variantName != nullptr) {
+        knownVariant = strlen(variantName) == 1 && gt7PacketVariantForHeartbeat(variantName[0], variant);
+    } else if (replayPath != nullptr) {
+        knownVariant = gt7PacketVariantForSize(replaySource.peekLength(), variant);
+    }
+    if (!knownVariant) {
+        fprintf(stderr, "unknown packet layout\n");
+        return 1;
+    }
+    gt7Telem.setPacketVariant(variant);
+    VibrationConfig config = defaultVibrationConfig();
+    FileConfigStorage configStorage(configPath != nullptr ? configPath : "");
+    if (configPath != nullptr && !loadVibrationConfig(configStorage, config)) {
+        fprintf(stderr, "no config in %s\n", configPath);
+        return 1;
+    }
+    FileCarProfileStorage profileStorage(profileDir != nullptr ? profileDir : "");
+
+    logStart(INGEST_CORE);
+    pipeline.begin(gt7Telem, vibration, mixer, out);
+    pipeline.getConfig().publish(config);
+    pipeline.getCarProfiles().begin(profileDir != nullptr ? &profileStorage : nullptr);
+    pipeline.start();
+    uint32_t startT = clockMillis();
+    while (durationMs == 0 || clockMillis() - startT < durationMs) {
+        if (replayPath != nullptr && replaySource.finished()) {
+            clockDelay(100); // let the audio task pick up the last packet
+            break;
+        }
+        clockDelay(10);
+    }
+    pipeline.stop();
+    logStop();
+    joinTasks();
+    pipeline.getCarProfiles().flush();
+
+    const IngestStats& stats = gt7Telem.getIngestStats();
+    fprintf(stderr, "received %u accepted %u superseded %u max backlog %u rejected: short %u long %u magic %u packetId %u\n",
+            stats.received.load(), stats.accepted.load(), stats.superseded.load(), stats.maxBacklog.load(),
+            stats.rejectedShort.load(), stats.rejectedLong.load(), stats.rejectedMagic.load(), stats.rejectedPacketId.load());
+    fprintf(stderr, "audio blocks %u underruns %u telemetry frames %u dropped haptic events %u\n",
+            pipeline.getRenderedBlocks(), out.getUnderruns(), pipeline.getTelemetry().version(), pipeline.getDroppedEvents());
+    fprintf(stderr, "dropped log records %u\n", logDropped());
+    if (profileDir != nullptr) {
+        fprintf(stderr, "car profiles loaded %u save failures %u\n", pipeline.getCarProfiles().getLoads(), pipeline.getCarProfiles().getSaveFailures());
+    }
+    if (capturePath != nullptr) {
+        fprintf(stderr, "captured %u failed %u\n", capturingSource.getCaptured(), capturingSource.getFailed());
+    }
+    if (replayPath != nullptr) {
+        fprintf(stderr, "replayed %u\n", replaySource.getReplayed());
+    }
+
+    static char metrics[3072];
+    pipeline.formatMetrics(metrics, sizeof(metrics));
+    fputs(metrics, stderr);
+    return 0;
+}
@@ -0,0 +1,146 @@
+// Offline renderer: decodes a capture (see PacketCapture.h) with the same
+// parser, vibration engine and mixer as the receiver and writes the shaker
+// signal to a WAV file as fast as the CPU allows. Time is taken from the
+// sample count, so the output only depends on the capture and the settings.
+//
+//   render capture.gt7c out.wav [-m mono|lr|fr] [-C config.bin] [-P name=value ...] [-W config.bin] [-K profiles-dir]
+//
+// -m routes the per-wheel effects to left/right or front/rear channel, -C
+// starts from a stored config instead of config.cpp, -P overrides a setting
+// from config.h, e.g. -P rpmIntensity=80 -P useTireSlip=0, and -W stores the
+// resulting config for the receiver (-C) or another render. -K starts from
+// the car profiles in a directory (see receiver -K) and stores what the
+// capture taught them; without it every car is learned from scratch.
+
+#include <chrono>
+#include <stdio.h>
+#include <unistd.h>
+#include "../PlatformNative.h"
+#include "../../GT7UDPParser.h"
+#include "../../PacketCapture.h"
+#include "../../Settings.h"
+#include "../../TelemetryPipeline.h"
+#include "../../VibrationEngine.h"
+#include "../../Wavetable.h"
+#include "../../config.h"
+
+// Rendered after the last packet so bursts and ramps can decay
+static const uint32_t TAIL_MICROS = 250000;
+
+static const char* const USAGE = "usage: %s capture.gt7c out.wav [-m mono|lr|fr] [-C config.bin] [-P name=value ...] [-W config.bin] [-K profiles-dir]\n";
+
+int main(int argc, char** argv) {
+    ChannelRouting routing = ChannelRouting::Mono;
+    VibrationConfig config = defaultVibrationConfig();
+    const char* savePath = nullptr;
+    const char* profileDir = nullptr;
+    int opt;
+    while ((opt = getopt(argc, argv, "m:C:P:W:K:")) != -1) {
+        bool valid = true;
+        switch (opt) {
+            case 'm': valid = parseChannelRouting(optarg, routing); break;
+            case 'C': {
+                FileConfigStorage storage(optarg);
+                if (!loadVibrationConfig(storage, config)) {
+                    fprintf(stderr, "no config in %s\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+            case 'P': {
+                SettingResult result = applySettingAssignment(config, optarg);
+                if (result != SettingResult::Ok) {
+                    fprintf(stderr, "%s: %s\n", optarg, settingResultName(result));
+                    return 2;
+                }
+                break;
+            }
+            case 'W': savePath = optarg; break;
+            case 'K': profileDir = optarg; break;
+            default: valid = false; break;
+        }
+        if (!valid) {
+            fprintf(stderr, USAGE, argv[0]);
+            return 2;
+        }
+    }
+    if (argc - optind != 2) {
+        fprintf(stderr, USAGE, argv[0]);
+        return 2;
+    }
+    if (savePath != nullptr) {
+        FileConfigStorage storage(savePath);
+        if (!saveVibrationConfig(storage, config)) {
+            fprintf(stderr, "cannot write %s\n", savePath);
+            return 1;
+        }
+    }
+    const char* capturePath = argv[optind];
+    const char* wavPath = argv[optind + 1];
+
+    MappedFile capture;
+    if (!capture.open(capturePath)) {
+        fprintf(stderr, "cannot map %s\n", capturePath);
+        return 1;
+    }
+    ReplayPacketSource replay(capture.data(), capture.size());
+    WavAudioSink wav(wavPath);
+    WavetableOscillator tones[VIBRATION_VOICES];
+    HapticMixer mixer;
+    GT7_UDP_Parser gt7Telem;
+    VibrationEngine vibration;
+    TelemetryPipeline pipeline;
+
+    if (!wav.begin(SAMPLE_RATE, CHANNELS)) {
+        fprintf(stderr, "cannot create %s\n", wavPath);
+        return 1;
+    }
+    mixer.begin(SAMPLE_RATE);
+    vibration.begin(mixer, tones);
+    vibration.setRouting(routing);
+    gt7Telem.begin(replay);
+    gt7Telem.setIngestMode(IngestMode::LatestWins);
+    GT7PacketVariant variant;
+    if (replay.finished() || !gt7PacketVariantForSize(replay.peekLength(), variant)) {
+        fprintf(stderr, "%s is not a capture file\n", capturePath);
+        return 1;
+    }
+    gt7Telem.setPacketVariant(variant);
+    pipeline.begin(gt7Telem, vibration, mixer, wav);
+    pipeline.getConfig().publish(config);
+    FileCarProfileStorage profileStorage(profileDir != nullptr ? profileDir : "");
+    pipeline.getCarProfiles().begin(profileDir != nullptr ? &profileStorage : nullptr);
+
+    auto wallStart = std::chrono::steady_clock::now();
+    uint64_t frames = 0;
+    uint64_t endMicros = UINT64_MAX;
+    for (;;) {
+        uint64_t nowMicros = frames * 1000000u / SAMPLE_RATE;
+        if (nowMicros >= endMicros) {
+            break;
+        }
+        // Packets that would have arrived before this block, as the audio
+        // task only sees the newest one
+        replay.setVirtualTime(static_cast<uint32_t>(nowMicros));
+        while (pipeline.ingest()) {
+        }
+        if (replay.finished() && endMicros == UINT64_MAX) {
+            endMicros = nowMicros + TAIL_MICROS;
+        }
+        pipeline.renderBlock(static_cast<uint32_t>(nowMicros / 1000));
+        frames += AUDIO_BLOCK_FRAMES;
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    pipeline.getCarProfiles().flush();
+    if (!wav.close()) {
+        fprintf(stderr, "cannot write %s\n", wavPath);
+        return 1;
+    }
+
+    const IngestStats& stats = gt7Telem.getIngestStats();
+    double audioSeconds = static_cast<double>(frames) / SAMPLE_RATE;
+    fprintf(stderr, "packets %u accepted %u superseded %u, %u blocks\n", stats.received.load(), stats.accepted.load(),
+            stats.superseded.load(), pipeline.getRenderedBlocks());
+    fprintf(stderr, "rendered %.1f s in %.3f s, %.0fx real time\n", audioSeconds, wallSeconds, audioSeconds / wallSeconds);
+    return 0;
+}
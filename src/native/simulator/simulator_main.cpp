@@ -0,0 +1,398 @@
+// PlayStation stand-in: waits for a heartbeat on port 33739 and streams
+// Salsa20 encrypted telemetry packets back to the sender on port 33740, like
+// GT7 does. The heartbeat byte ('A', 'B' or '~') selects the packet layout.
+// Streaming stops when heartbeats stay away, so the receiver's heartbeat
+// handling is exercised as well.
+//
+//   simulator [-P profile] [-r rate] [-d seconds] [-l loss%] [-o reorder%] [-b burst] [-S seed]
+//
+// -r is in packets per second (GT7 sends 60), thousands are fine for load
+// tests. -l drops, -o swaps packets with their successor, -b holds back that
+// many packets once a second and then sends them back to back (a Wi-Fi stall).
+// Packet ids keep counting across lost packets, as on the console.
+
+#include <arpa/inet.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "../PlatformNative.h"
+#include "../../GT7UDPParser.h"
+#include "../../Salsa20Engine.h"
+
+// The console stops sending a while after the last heartbeat
+static const uint32_t HEARTBEAT_TIMEOUT_MS = 5000;
+static const size_t MAX_BURST = 1024;
+
+static const float PI = 3.14159265f;
+static const float TYRE_RADIUS = 0.32f;
+static const int16_t MIN_ALERT_RPM = 6500;
+static const int16_t MAX_ALERT_RPM = 7500;
+// Road speed in m/s per 1000 rpm in gears 1..6
+static const float GEAR_SPEED[6] = { 2.8f, 4.6f, 6.4f, 8.2f, 10.0f, 11.8f };
+
+static volatile sig_atomic_t interrupted = 0;
+
+// clockMicros() wraps after 71 minutes, the send schedule must not
+static uint64_t monotonicMicros() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + static_cast<uint64_t>(ts.tv_nsec) / 1000;
+}
+
+static void onSignal(int) {
+    interrupted = 1;
+}
+
+// Fills in the driving state for t seconds into the profile. The state only
+// depends on t, so lost packets do not change what the receiver sees next.
+// The motion channels are only sent for the 'B' and '~' heartbeats.
+typedef void (*ProfileFunction)(float t, GT7Packet& packet, GT7PacketMotion& motion);
+
+struct Variant {
+    char heartbeat;
+    size_t size;
+    uint32_t ivXor;
+};
+
+template <GT7PacketVariant V> static constexpr Variant variantOf() {
+    return { GT7PacketLayout<V>::heartbeat, sizeof(typename GT7PacketLayout<V>::Type), GT7PacketLayout<V>::ivXor };
+}
+
+static const Variant variants[] = {
+    variantOf<GT7PacketVariant::A>(), variantOf<GT7PacketVariant::B>(), variantOf<GT7PacketVariant::Tilde>()
+};
+
+static void setGear(GT7Packet& packet, uint8_t gear, float rpm) {
+    packet.gears = static_cast<uint8_t>(gear | ((gear < 6 ? gear + 1 : 6) << 4));
+    packet.EngineRPM = rpm;
+    packet.RPMFromClutchToGearbox = rpm;
+    packet.speed = GEAR_SPEED[gear - 1] * rpm / 1000;
+    for (int i = 0; i < 4; ++i) {
+        packet.wheelRPS[i] = packet.speed / TYRE_RADIUS;
+    }
+    int16_t flags = static_cast<int16_t>(SimulatorFlags::CarOnTrack) | static_cast<int16_t>(SimulatorFlags::InGear);
+    if (rpm >= MIN_ALERT_RPM) {
+        flags |= static_cast<int16_t>(SimulatorFlags::RevLimiterBlinkAlertActive);
+    }
+    packet.flags = static_cast<SimulatorFlags>(flags);
+}
+
+// Third gear, revs swept up and down between idle and the limiter
+static void profileRevs(float t, GT7Packet& packet, GT7PacketMotion&) {
+    float rpm = 4250 - 3250 * cosf(2 * PI * t / 8);
+    setGear(packet, 3, rpm);
+    packet.throttle = static_cast<uint8_t>(sinf(2 * PI * t / 8) > 0 ? 255 : 0);
+}
+
+// Full throttle through all six gears, shifting at the limiter every 2 s
+static void profileShifts(float t, GT7Packet& packet, GT7PacketMotion& motion) {
+    float phase = fmodf(t, 12);
+    uint8_t gear = static_cast<uint8_t>(1 + phase / 2);
+    float inGear = fmodf(phase, 2) / 2;
+    setGear(packet, gear, 4000 + 3600 * inGear);
+    packet.throttle = 255;
+    // Speed gained per second in this gear, with a dip while shifting
+    motion.surge = GEAR_SPEED[gear - 1] * 1.8f * (inGear < 0.05f ? 0.2f : 1);
+}
+
+// Launches where the rear wheels spin up and the traction control cuts in
+static void profileWheelspin(float t, GT7Packet& packet, GT7PacketMotion& motion) {
+    float phase = fmodf(t, 5);
+    setGear(packet, 1, 3000 + 800 * phase);
+    packet.throttle = 255;
+    motion.surge = GEAR_SPEED[0] * 0.8f;
+    if (phase < 2.5f) {
+        float slip = 1.2f + 0.6f * sinf(2 * PI * 3 * phase);
+        packet.wheelRPS[2] *= slip;
+        packet.wheelRPS[3] *= slip;
+        packet.EngineRPM *= slip;
+        packet.flags = static_cast<SimulatorFlags>(static_cast<int16_t>(packet.flags) | static_cast<int16_t>(SimulatorFlags::TCSActive));
+    }
+}
+
+// Constant speed, a one second kerb every 4 s rattling the suspension
+static void profileKerbs(float t, GT7Packet& packet, GT7PacketMotion& motion) {
+    setGear(packet, 4, 5000);
+    packet.throttle = 180;
+    float phase = fmodf(t, 4);
+    for (int i = 0; i < 4; ++i) {
+        // Front wheels hit the kerb first, the rears follow
+        float wheelPhase = phase - (i < 2 ? 0 : 0.05f);
+        bool onKerb = wheelPhase >= 2 && wheelPhase < 3;
+        // 12 Hz: 30 Hz would be the Nyquist frequency of the 60 Hz packets
+        // and sample as 0 on every one of them
+        packet.suspHeight[i] = 0.08f + (onKerb ? 0.015f * sinf(2 * PI * 12 * wheelPhase) : 0);
+    }
+    packet.roadPlaneDistance = phase >= 2 && phase < 3 ? 0.02f : 0;
+    // A long right hander, the kerb on its apex
+    motion.wheelRotation = 0.3f * sinf(PI * phase / 4);
+    motion.sway = 9 * sinf(PI * phase / 4);
+    motion.heave = phase >= 2 && phase < 3 ? 6 * sinf(2 * PI * 12 * phase) : 0;
+}
+
+static const ProfileFunction lapSections[] = { profileShifts, profileKerbs, profileWheelspin, profileRevs };
+
+// All of the above, 12 s each
+static void profileLap(float t, GT7Packet& packet, GT7PacketMotion& motion) {
+    float section = fmodf(t, 48) / 12;
+    lapSections[static_cast<int>(section)](t, packet, motion);
+}
+
+struct Profile {
+    const char* name;
+    ProfileFunction generate;
+};
+
+static const Profile profiles[] = {
+    { "lap", profileLap },
+    { "revs", profileRevs },
+    { "shifts", profileShifts },
+    { "wheelspin", profileWheelspin },
+    { "kerbs", profileKerbs },
+};
+
+// Deterministic per seed, so a fault pattern can be reproduced
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static bool chance(uint32_t& state, float percent) {
+    return percent > 0 && nextRandom(state) % 10000 < percent * 100;
+}
+
+// Builds packet number packetId at profile time t in the given layout and
+// encrypts it the way the console does: random seed IV at 0x40,
+// nonce = (seed ^ ivXor, seed)
+static void buildPacket(const Salsa20Engine& salsa20, ProfileFunction generate, float t, int32_t packetId, uint32_t seedIv,
+                        const Variant& variant, GT7PacketTilde& full) {
+    memset(&full, 0, sizeof(full));
+    GT7Packet& packet = full.base;
+    packet.magic = gt7Magic;
+    packet.packetId = packetId;
+    packet.fuelLevel = 50;
+    packet.fuelCapacity = 100;
+    packet.waterTemp = 85;
+    packet.oilTemp = 110;
+    packet.lapCount = 1;
+    packet.totalLaps = 5;
+    packet.bestLaptime = -1;
+    packet.lastLaptime = -1;
+    packet.RaceStartPosition = -1;
+    packet.preRaceNumCars = -1;
+    packet.minAlertRPM = MIN_ALERT_RPM;
+    packet.maxAlertRPM = MAX_ALERT_RPM;
+    packet.carCode = 3396;
+    packet.clutchEngagement = 1;
+    for (int i = 0; i < 4; ++i) {
+        packet.tyreRadius[i] = TYRE_RADIUS;
+        packet.tyreTemp[i] = 80;
+        packet.suspHeight[i] = 0.08f;
+    }
+    generate(t, packet, full.motion);
+    full.extended.throttleFiltered = packet.throttle;
+    full.extended.brakeFiltered = packet.brake;
+
+    uint32_t iv2 = seedIv ^ variant.ivXor;
+    const uint8_t iv[Salsa20Engine::IV_SIZE] = {
+        static_cast<uint8_t>(iv2), static_cast<uint8_t>(iv2 >> 8), static_cast<uint8_t>(iv2 >> 16), static_cast<uint8_t>(iv2 >> 24),
+        static_cast<uint8_t>(seedIv), static_cast<uint8_t>(seedIv >> 8), static_cast<uint8_t>(seedIv >> 16), static_cast<uint8_t>(seedIv >> 24)
+    };
+    uint8_t* data = reinterpret_cast<uint8_t*>(&full);
+    salsa20.process(iv, data, variant.size);
+    memcpy(&data[0x40], &seedIv, sizeof(seedIv));
+}
+
+struct SimulatorStats {
+    uint32_t heartbeats = 0;
+    uint32_t generated = 0;
+    uint32_t sent = 0;
+    uint32_t lost = 0;
+    uint32_t reordered = 0;
+    uint32_t bursts = 0;
+    uint32_t late = 0; // send slots missed because the loop fell behind
+};
+
+int main(int argc, char** argv) {
+    const Profile* profile = &profiles[0];
+    float rate = 60;
+    uint32_t durationMs = 0;
+    float lossPercent = 0;
+    float reorderPercent = 0;
+    size_t burst = 0;
+    uint32_t randomState = 0x2545F491;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "P:r:d:l:o:b:S:")) != -1) {
+        switch (opt) {
+            case 'P':
+                profile = nullptr;
+                for (const Profile& p : profiles) {
+                    if (strcmp(p.name, optarg) == 0) {
+                        profile = &p;
+                    }
+                }
+                break;
+            case 'r': rate = static_cast<float>(atof(optarg)); break;
+            case 'd': durationMs = static_cast<uint32_t>(atof(optarg) * 1000); break;
+            case 'l': lossPercent = static_cast<float>(atof(optarg)); break;
+            case 'o': reorderPercent = static_cast<float>(atof(optarg)); break;
+            case 'b': burst = static_cast<size_t>(atoi(optarg)); break;
+            case 'S': randomState = static_cast<uint32_t>(strtoul(optarg, nullptr, 0)) | 1; break;
+            default: profile = nullptr; break;
+        }
+    }
+    if (profile == nullptr || rate <= 0 || burst > MAX_BURST) {
+        fprintf(stderr, "usage: %s [-P lap|revs|shifts|wheelspin|kerbs] [-r rate] [-d seconds] [-l loss%%] [-o reorder%%] [-b burst] [-S seed]\n", argv[0]);
+        return 2;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(gt7HeartbeatPort);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+        fprintf(stderr, "cannot bind port %u\n", gt7HeartbeatPort);
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    uint8_t key[Salsa20Engine::KEY_SIZE];
+    memcpy(key, gt7Key, sizeof(key));
+    Salsa20Engine salsa20;
+    salsa20.setKey(key);
+
+    SimulatorStats stats;
+    sockaddr_in receiver = {};
+    bool streaming = false;
+    const Variant* variant = &variants[0];
+    uint32_t lastHeartbeatMs = 0;
+    uint64_t intervalMicros = static_cast<uint64_t>(1000000 / rate);
+    intervalMicros = intervalMicros > 0 ? intervalMicros : 1;
+    uint64_t startMicros = 0;
+    uint64_t sequence = 0;
+    int32_t packetId = 0;
+
+    // Packets waiting for their successor (reorder) or for the burst to fill
+    static GT7PacketTilde pending[MAX_BURST + 1];
+    size_t pendingCount = 0;
+    bool holdingForReorder = false;
+    uint32_t burstStartMs = 0;
+
+    auto sendPacket = [&](const GT7PacketTilde& packet) {
+        ssize_t size = static_cast<ssize_t>(variant->size);
+        if (sendto(fd, &packet, variant->size, 0, reinterpret_cast<sockaddr*>(&receiver), sizeof(receiver)) == size) {
+            ++stats.sent;
+        }
+    };
+
+    fprintf(stderr, "waiting for heartbeats on port %u, profile %s, %.0f packets/s\n", gt7HeartbeatPort, profile->name, rate);
+    uint32_t startT = clockMillis();
+    while (!interrupted && (durationMs == 0 || clockMillis() - startT < durationMs)) {
+        uint32_t nowMs = clockMillis();
+        uint8_t message[16];
+        sockaddr_in from = {};
+        socklen_t fromLength = sizeof(from);
+        ssize_t length;
+        while ((length = recvfrom(fd, message, sizeof(message), MSG_DONTWAIT, reinterpret_cast<sockaddr*>(&from), &fromLength)) > 0) {
+            const Variant* requested = nullptr;
+            for (const Variant& v : variants) {
+                if (length == 1 && message[0] == static_cast<uint8_t>(v.heartbeat)) {
+                    requested = &v;
+                }
+            }
+            if (requested != nullptr) {
+                ++stats.heartbeats;
+                if (requested != variant) {
+                    // Packets built for the old layout are not sent any more
+                    variant = requested;
+                    pendingCount = 0;
+                    holdingForReorder = false;
+                }
+                lastHeartbeatMs = nowMs;
+                receiver = from;
+                receiver.sin_port = htons(gt7ReceivePort);
+                if (!streaming) {
+                    char address[INET_ADDRSTRLEN];
+                    inet_ntop(AF_INET, &receiver.sin_addr, address, sizeof(address));
+                    fprintf(stderr, "streaming '%c' packets (%zu bytes) to %s:%u\n", variant->heartbeat, variant->size, address, gt7ReceivePort);
+                    streaming = true;
+                    startMicros = monotonicMicros();
+                    sequence = 0;
+                    burstStartMs = nowMs;
+                }
+            }
+            fromLength = sizeof(from);
+        }
+        if (streaming && nowMs - lastHeartbeatMs > HEARTBEAT_TIMEOUT_MS) {
+            fprintf(stderr, "heartbeat timeout, stopped streaming\n");
+            streaming = false;
+            pendingCount = 0;
+            holdingForReorder = false;
+        }
+        if (!streaming) {
+            clockDelay(10);
+            continue;
+        }
+
+        // Absolute schedule, so rounding in the sleep does not add up to drift
+        uint64_t due = startMicros + sequence * intervalMicros;
+        uint64_t now = monotonicMicros();
+        if (now < due) {
+            uint64_t wait = due - now;
+            usleep(static_cast<useconds_t>(wait < 10000 ? wait : 10000));
+            continue;
+        }
+        if (now - due > intervalMicros) {
+            ++stats.late;
+        }
+        float t = static_cast<float>(sequence * intervalMicros) / 1000000;
+        ++sequence;
+        ++packetId;
+        ++stats.generated;
+        if (chance(randomState, lossPercent)) {
+            ++stats.lost;
+            continue;
+        }
+
+        GT7PacketTilde& packet = pending[pendingCount++];
+        buildPacket(salsa20, profile->generate, t, packetId, nextRandom(randomState), *variant, packet);
+        if (burst > 0 && nowMs - burstStartMs >= 1000) {
+            // Stall: keep collecting until the burst is full, then flush
+            if (pendingCount <= burst) {
+                continue;
+            }
+            ++stats.bursts;
+            burstStartMs = nowMs;
+            holdingForReorder = false;
+        } else if (holdingForReorder) {
+            // Send the newer packet first, then the one held back
+            GT7PacketTilde newer = packet;
+            pending[pendingCount - 1] = pending[0];
+            pending[0] = newer;
+            holdingForReorder = false;
+            ++stats.reordered;
+        } else if (pendingCount == 1 && chance(randomState, reorderPercent)) {
+            holdingForReorder = true;
+            continue;
+        }
+        for (size_t i = 0; i < pendingCount; ++i) {
+            sendPacket(pending[i]);
+        }
+        pendingCount = 0;
+    }
+
+    close(fd);
+    fprintf(stderr, "heartbeats %u generated %u sent %u lost %u reordered %u bursts %u late %u last packetId %d\n",
+            stats.heartbeats, stats.generated, stats.sent, stats.lost, stats.reordered, stats.bursts, stats.late, packetId);
+    return 0;
+}